@@ -9,6 +9,7 @@ BaseEffect::BaseEffect() {
 void BaseEffect::initialize(PluginProcessor &processorToUse) {
     processor = &processorToUse;
     timingManagerPtr = &processorToUse.getTimingManager();
+    random = &processorToUse.getRandomService().getStream(RandomService::Stream::Effects);
 }
 
 void BaseEffect::prepare(const juce::dsp::ProcessSpec &spec) {
@@ -31,7 +32,7 @@ void BaseEffect::reset() {
 }
 
 bool BaseEffect::shouldApplyEffect(float probability) {
-    return juce::Random::getSystemRandom().nextFloat() <= probability;
+    return random != nullptr && random->nextFloat() <= probability;
 }
 
 bool BaseEffect::hasMinTimePassed() {
@@ -23,6 +23,7 @@ public:
 protected:
     PluginProcessor *processor = nullptr;
     TimingManager *timingManagerPtr = nullptr;
+    RandomStream *random = nullptr; // The processor's effects stream, set by initialize
 
     // Common utility methods
     bool shouldApplyEffect(float probability);
@@ -184,7 +184,7 @@ void Stutter::startStutterAtPositionBlock(juce::dsp::AudioBlock<float> &outBlock
     isStuttering = true;
     stutterLength = captureLength;
     stutterPosition = 0;
-    stutterRepeatsTotal = 2 + random.nextInt(3); // 2-4 repeats
+    stutterRepeatsTotal = 2 + random->nextInt(3); // 2-4 repeats
     stutterRepeatCount = 0;
 
     // Apply stutter effect immediately for the rest of this block
@@ -323,7 +323,7 @@ Models::RateOption Stutter::selectRandomRate() {
                                   Models::RATE_1_16,
                                   Models::RATE_1_32};
 
-    float randomValue = random.nextFloat();
+    float randomValue = random->nextFloat();
 
     if (randomValue < 0.4f) {
         return rates[0]; // 1/8 note
@@ -50,9 +50,6 @@ private:
     int historyWritePosition{0};
     int historyBufferSize{0};
 
-    // Random number generator
-    juce::Random random;
-
     // Stutter effect methods
     bool shouldStutter();
 
@@ -1,9 +1,10 @@
 #include "NoteGenerator.h"
-#include "../../Gui/PluginEditor.h"
+#include "../PluginProcessor.h"
 
 NoteGenerator::NoteGenerator(PluginProcessor &processorRef)
         : processor(processorRef),
-          timingManager(processorRef.getTimingManager()) {
+          timingManager(processorRef.getTimingManager()),
+          random(processorRef.getRandomService().getStream(RandomService::Stream::Notes)) {
     releaseResources();
 
     scaleManager = std::make_unique<ScaleManager>(processor);
@@ -21,24 +22,48 @@ NoteGenerator::NoteGenerator(PluginProcessor &processorRef)
             makeFieldDescriptor(Params::ID_GATE_DIRECTION, &Models::MidiSettings::gateDirection),
             makeFieldDescriptor(Params::ID_VELOCITY, &Models::MidiSettings::velocityValue),
             makeFieldDescriptor(Params::ID_VELOCITY_RANDOMIZE, &Models::MidiSettings::velocityRandomize),
-            makeFieldDescriptor(Params::ID_VELOCITY_DIRECTION, &Models::MidiSettings::velocityDirection)
+            makeFieldDescriptor(Params::ID_VELOCITY_DIRECTION, &Models::MidiSettings::velocityDirection),
+            makeFieldDescriptor(Params::ID_INPUT_ONSETS, &Models::MidiSettings::inputOnsets),
+            makeFieldDescriptor(Params::ID_INPUT_ONSET_SENSITIVITY, &Models::MidiSettings::inputOnsetSensitivity)
     };
 
+    inputOnsetRates.reserve(Models::NUM_RATE_OPTIONS);
+
     settingsBinding = std::make_unique<StructParameter<Models::MidiSettings>>(
             processor.getModulationMatrix(), descriptors);
 }
 
-void NoteGenerator::prepareToPlay(double sampleRate, int) {
+void NoteGenerator::prepareToPlay(double sampleRate, int samplesPerBlock) {
     releaseResources();
+    inputOnsetDetector.prepare(sampleRate, samplesPerBlock);
+}
+
+void NoteGenerator::processInputAudio(const juce::AudioBuffer<float> &input, int numInputChannels) {
+    // Uses the settings read for the previous block, a change takes effect a block later
+    if (!settings.inputOnsets) {
+        inputOnsetsActive = false;
+        return;
+    }
+
+    if (!inputOnsetsActive) {
+        inputOnsetDetector.reset();
+        inputOnsetsActive = true;
+    }
+
+    inputOnsetDetector.setSensitivity(settings.inputOnsetSensitivity);
+    inputOnsetDetector.process(input, numInputChannels, input.getNumSamples());
 }
 
 void NoteGenerator::releaseResources() {
-    // Clear any active notes
+    // Clear any active notes. The editor is told, so its keyboard does not keep the key held
+    if (noteIsActive && currentActiveNote >= 0) {
+        processor.getEngineEvents().push({EngineEvent::Type::NoteOff, currentActiveNote});
+    }
     noteIsActive = false;
     isInputNoteActive = false;
     currentInputNote = -1;
     currentActiveNote = -1;
-    currentActiveSampleIdx = -1;
+    setActiveSample(-1);
 
     // Clear pending notes
     pendingNotes.clear();
@@ -73,6 +98,10 @@ void NoteGenerator::processIncomingMidi(const juce::MidiBuffer &midiMessages,
     // Process any pending notes scheduled from previous buffers
     processPendingNotes(processedMidi, numSamples);
 
+    if (inputOnsetsActive) {
+        playInputOnsets(processedMidi);
+    }
+
     // Generates midi based on settings
     generateNewNotes(processedMidi);
 }
@@ -89,9 +118,10 @@ void NoteGenerator::checkActiveNotes(juce::MidiBuffer &midiMessages, int numSamp
             // Send note off at the exact sample position it should end
             midiMessages.addEvent(juce::MidiMessage::noteOff(1, currentActiveNote),
                                   static_cast<int>(noteEndPosition));
+            processor.getEngineEvents().push({EngineEvent::Type::NoteOff, currentActiveNote});
             noteIsActive = false;
             currentActiveNote = -1;
-            currentActiveSampleIdx = -1;
+            setActiveSample(-1);
         }
     }
 }
@@ -128,7 +158,7 @@ Models::RateOption NoteGenerator::selectRateFromEligible(const std::vector<Eligi
         return Models::RATE_1_4; // Default to quarter notes
 
     // Select a rate based on weighted probability
-    float randomValue = juce::Random::getSystemRandom().nextFloat() * totalWeight;
+    float randomValue = random.nextFloat() * totalWeight;
     float cumulativeWeight = 0.0f;
 
     for (const auto &rate: eligibleRates) {
@@ -154,7 +184,7 @@ void NoteGenerator::generateNewNotes(juce::MidiBuffer &midiMessages) {
         // Determine if any note should play
         float triggerProbability = settings.probability;
         bool shouldPlayNote =
-                juce::Random::getSystemRandom().nextFloat() < triggerProbability
+                random.nextFloat() < triggerProbability
                 || settings.probability == 100.0f;
 
         if (shouldPlayNote) {
@@ -255,15 +285,57 @@ void NoteGenerator::addNoteWithinCurrentBuffer(juce::MidiBuffer &midiMessages,
     // Store the active note data
     currentActiveNote = noteToPlay;
     currentActiveVelocity = velocity;
-    currentActiveSampleIdx = sampleIndex;
+    setActiveSample(sampleIndex);
 
     noteStartPosition = absoluteNotePosition;
     noteDurationInSamples = noteLengthSamples;
     noteIsActive = true;
 
-    // Update keyboard state
-    if (auto *editor = dynamic_cast<PluginEditor *>(processor.getActiveEditor())) {
-        editor->updateKeyboardState(true, currentActiveNote, currentActiveVelocity);
+    processor.getEngineEvents().push({EngineEvent::Type::NoteOn, currentActiveNote, currentActiveVelocity});
+}
+
+void NoteGenerator::playInputOnsets(juce::MidiBuffer &midiMessages) {
+    for (int i = 0; i < inputOnsetDetector.getNumOnsets(); ++i) {
+        const auto &onset = inputOnsetDetector.getOnset(i);
+
+        bool shouldPlayNote =
+                random.nextFloat() < settings.probability
+                || settings.probability == 100.0f;
+        if (!shouldPlayNote) {
+            continue;
+        }
+
+        // Hits ignore the grid, the rate weights still pick the note length and sample
+        float totalWeight = 0.0f;
+        inputOnsetRates.clear();
+        for (int rateIndex = 0; rateIndex < Models::NUM_RATE_OPTIONS; ++rateIndex) {
+            auto rateValue = settings.getRateValueByIdx(rateIndex);
+            if (rateValue > 0.0f) {
+                inputOnsetRates.push_back({static_cast<Models::RateOption>(rateIndex), rateValue});
+                totalWeight += rateValue;
+            }
+        }
+        Models::RateOption selectedRate = selectRateFromEligible(inputOnsetRates, totalWeight);
+
+        // Monophonic, a new hit cuts the note before it
+        stopActiveNote(midiMessages, onset.sampleOffset);
+
+        int inputNote = isInputNoteActive ? currentInputNote : defaultInputOnsetNote;
+        int noteToPlay = scaleManager->applyScaleAndModifications(inputNote);
+        int velocity = juce::jlimit(1, 127, juce::roundToInt(static_cast<float>(calculateVelocity()) * onset.strength));
+
+        int sampleIndex = -1;
+        if (processor.getSampleManager().isSampleLoaded()) {
+            sampleIndex = processor.getSampleManager().getNextSampleIndex(selectedRate);
+        }
+
+        addNoteWithinCurrentBuffer(midiMessages,
+                                   noteToPlay,
+                                   velocity,
+                                   onset.sampleOffset,
+                                   timingManager.getSamplePosition() + onset.sampleOffset,
+                                   calculateNoteLength(selectedRate),
+                                   sampleIndex);
     }
 }
 
@@ -288,16 +360,12 @@ void NoteGenerator::processPendingNotes(juce::MidiBuffer &midiMessages, int numS
             // Update the active note info
             currentActiveNote = it->noteNumber;
             currentActiveVelocity = it->velocity;
-            currentActiveSampleIdx = it->sampleIndex;
+            setActiveSample(it->sampleIndex);
             noteStartPosition = it->startSamplePosition;
             noteDurationInSamples = it->durationInSamples;
             noteIsActive = true;
 
-            // Update keyboard state
-            if (auto *editor = dynamic_cast<PluginEditor *>(processor.getActiveEditor())) {
-                editor->updateKeyboardState(
-                        true, currentActiveNote, currentActiveVelocity);
-            }
+            processor.getEngineEvents().push({EngineEvent::Type::NoteOn, currentActiveNote, currentActiveVelocity});
 
             // Remove the played note from pending list
             it = pendingNotes.erase(it);
@@ -357,16 +425,16 @@ float NoteGenerator::applyRandomization(float value,
     float maxValue = juce::jmin(100.0f, value + randomizeValue);
     float minValue = juce::jmax(0.0f, value - randomizeValue);
     float rightValue =
-            juce::jmap(juce::Random::getSystemRandom().nextFloat(), value, maxValue);
+            juce::jmap(random.nextFloat(), value, maxValue);
     float leftValue =
-            juce::jmap(juce::Random::getSystemRandom().nextFloat(), minValue, value);
+            juce::jmap(random.nextFloat(), minValue, value);
 
     if (direction == Models::DirectionType::RIGHT) {
         return rightValue;
     } else if (direction == Models::DirectionType::LEFT) {
         return leftValue;
     } else {
-        return juce::Random::getSystemRandom().nextFloat() > 0.5 ? rightValue : leftValue;
+        return random.nextFloat() > 0.5 ? rightValue : leftValue;
     }
 }
 
@@ -377,12 +445,16 @@ void NoteGenerator::stopActiveNote(juce::MidiBuffer &midiMessages,
         midiMessages.addEvent(juce::MidiMessage::noteOff(1, currentActiveNote),
                               currentSamplePosition);
 
-        // Update keyboard state
-        if (auto *editor = dynamic_cast<PluginEditor *>(processor.getActiveEditor())) {
-            editor->updateKeyboardState(false, currentActiveNote, 0);
-        }
+        processor.getEngineEvents().push({EngineEvent::Type::NoteOff, currentActiveNote});
 
         noteIsActive = false;
         currentActiveNote = -1;
     }
-}
\ No newline at end of file
+}
+
+void NoteGenerator::setActiveSample(int sampleIndex) {
+    if (sampleIndex != currentActiveSampleIdx) {
+        currentActiveSampleIdx = sampleIndex;
+        processor.getEngineEvents().push({EngineEvent::Type::ActiveSampleChanged, -1, 0, sampleIndex});
+    }
+}
@@ -6,10 +6,12 @@
 #include "../../Shared/Parameters/StructParameter.h"
 #include "../../Shared/Parameters/Params.h"
 #include "ScaleManager.h"
+#include "../Sampler/LiveOnsetDetector.h"
+#include "../../Shared/RandomService.h"
+#include <atomic>
 
 class PluginProcessor;
 class ScaleManager;
-class PluginEditor;
 
 /**
  * Class to handle note generation and MIDI processing functionality
@@ -39,6 +41,10 @@ public:
     // Clear state before releasing resources
     void releaseResources();
 
+    // Listens for hits on the input bus, call before the buffer is cleared for output.
+    // Notes for them are added by the following processIncomingMidi
+    void processInputAudio(const juce::AudioBuffer<float> &input, int numInputChannels);
+
     // Process MIDI in for note tracking
     void processIncomingMidi(const juce::MidiBuffer &midiMessages,
                              juce::MidiBuffer &processedMidi,
@@ -49,10 +55,15 @@ public:
 
     float getCurrentRandomizedVelocity() const { return currentRandomizedVelocity; }
 
+    // The note state below is also read by the editor when it opens, so it is kept in atomics
     int getCurrentActiveSampleIdx() const { return currentActiveSampleIdx; }
 
     bool isNoteActive() const { return noteIsActive; }
 
+    int getCurrentActiveNote() const { return currentActiveNote; }
+
+    int getCurrentActiveVelocity() const { return currentActiveVelocity; }
+
     juce::int64 getCurrentNoteDuration() const { return noteDurationInSamples; }
 
     // Get the list of pending notes
@@ -69,22 +80,29 @@ private:
     // Managers for specific functionality
     std::unique_ptr<ScaleManager> scaleManager;
     TimingManager &timingManager;
+    RandomStream &random;
 
     // MIDI generation state
     // Monophonic note tracking
-    int currentActiveNote = -1;
-    int currentActiveVelocity = 0;
+    std::atomic<int> currentActiveNote{-1};
+    std::atomic<int> currentActiveVelocity{0};
     juce::int64 noteStartPosition = 0;
     juce::int64 noteDurationInSamples = 0;
-    bool noteIsActive = false;
+    std::atomic<bool> noteIsActive{false};
 
     int currentInputNote = -1;
     bool isInputNoteActive = false;
-    int currentActiveSampleIdx = -1;
+    std::atomic<int> currentActiveSampleIdx{-1};
 
     // Pending notes for future processing
     std::vector<PendingNote> pendingNotes;
 
+    // Live input, the note played for a hit when no MIDI note is held
+    static constexpr int defaultInputOnsetNote = 60;
+    LiveOnsetDetector inputOnsetDetector;
+    bool inputOnsetsActive = false;
+    std::vector<EligibleRate> inputOnsetRates;
+
     // Randomized values for visualization
     std::atomic<float> currentRandomizedGate{0.0f};
     std::atomic<float> currentRandomizedVelocity{0.0f};
@@ -118,6 +136,9 @@ private:
     // Play a new note at the specified rate
     void playNewNote(Models::RateOption selectedRate, juce::MidiBuffer &midiMessages);
 
+    // Play a note at each onset found on the input this block
+    void playInputOnsets(juce::MidiBuffer &midiMessages);
+
     // Process pending notes (scheduled for future buffers)
     void processPendingNotes(juce::MidiBuffer &midiMessages, int numSamples);
 
@@ -133,4 +154,7 @@ private:
     // Stop an active note
     void stopActiveNote(juce::MidiBuffer &midiMessages, int currentSamplePosition);
 
+    // Tells the editor when the sample being played changes
+    void setActiveSample(int sampleIndex);
+
 };
\ No newline at end of file
@@ -1,7 +1,8 @@
 #include "ScaleManager.h"
 #include "../../Audio/PluginProcessor.h"
 
-ScaleManager::ScaleManager(PluginProcessor &p) : processor(p) {
+ScaleManager::ScaleManager(PluginProcessor &p)
+        : processor(p), random(p.getRandomService().getStream(RandomService::Stream::Melody)) {
     resetArpeggiator();
 
     std::vector<StructParameter<Models::MelodySettings>::FieldDescriptor> descriptors = {
@@ -31,7 +32,7 @@ int ScaleManager::applyScaleAndModifications(int noteNumber) {
     juce::Array<int> scale = getSelectedScale(settings.scaleType);
 
     if (settings.semitoneValue > 0 && settings.semitoneProbability > 0.0f) {
-        if (juce::Random::getSystemRandom().nextFloat()
+        if (random.nextFloat()
             < settings.semitoneProbability) {
             switch (settings.semitoneDirection) {
                 case Models::DirectionType::LEFT:
@@ -63,7 +64,7 @@ int ScaleManager::applyScaleAndModifications(int noteNumber) {
                     break;
 
                 case Models::DirectionType::RANDOM:
-                    currentArpStep = juce::Random::getSystemRandom().nextInt(
+                    currentArpStep = random.nextInt(
                             settings.semitoneValue + 1);
                     break;
             }
@@ -79,13 +80,13 @@ int ScaleManager::applyScaleAndModifications(int noteNumber) {
     }
 
     if (settings.octaveValue > 0 && settings.octaveProbability > 0.0f) {
-        if (juce::Random::getSystemRandom().nextFloat()
+        if (random.nextFloat()
             < settings.octaveProbability) {
             int octaveAmount =
-                    1 + juce::Random::getSystemRandom().nextInt(settings.octaveValue);
+                    1 + random.nextInt(settings.octaveValue);
 
             if (settings.octaveBidirectional
-                && juce::Random::getSystemRandom().nextBool()) {
+                && random.nextBool()) {
                 octaveAmount = -octaveAmount;
             }
 
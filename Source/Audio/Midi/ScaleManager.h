@@ -4,6 +4,7 @@
 #include "../../Shared/Models.h"
 #include "../../Shared/Parameters/Params.h"
 #include "../../Shared/Parameters/StructParameter.h"
+#include "../../Shared/RandomService.h"
 
 class PluginProcessor;
 
@@ -33,6 +34,7 @@ public:
 
 private:
     PluginProcessor &processor;
+    RandomStream &random;
 
     std::unique_ptr<StructParameter<Models::MelodySettings>> settingsBinding;
     Models::MelodySettings settings;
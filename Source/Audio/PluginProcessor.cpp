@@ -14,6 +14,7 @@ PluginProcessor::PluginProcessor()
                 ParameterLoader::createParameterLayout()) {
 
     // init order matters! be aware
+    randomService = std::make_unique<RandomService>();
     modMatrix = std::make_unique<ModulationMatrix>(*this);
     timingManager = std::make_unique<TimingManager>();
     sampleManager = std::make_unique<::SampleManager>(*this);
@@ -84,7 +85,10 @@ void PluginProcessor::changeProgramName(int index, const juce::String &newName)
 
 //==============================================================================
 void PluginProcessor::prepareToPlay(double sampleRate, int samplesPerBlock) {
-    sampleManager->prepareToPlay(sampleRate);
+    // Every render from the start of playback draws the same sequence for the same seed
+    randomService->restart();
+
+    sampleManager->prepareToPlay(sampleRate, samplesPerBlock);
     noteGenerator->prepareToPlay(sampleRate, samplesPerBlock);
     fxEngine->prepareToPlay(sampleRate, samplesPerBlock);
 }
@@ -97,8 +101,13 @@ void PluginProcessor::releaseResources() {
 void PluginProcessor::processBlock(juce::AudioBuffer<float> &buffer,
                                    juce::MidiBuffer &midiMessages) {
 
+    randomService->applyPendingSeed();
+
     modMatrix->calculateModulationValues();
 
+    // The input is only listened to, the output is rendered from silence
+    noteGenerator->processInputAudio(buffer, getTotalNumInputChannels());
+
     buffer.clear();
 
     juce::MidiBuffer processedMidi;
@@ -108,14 +117,14 @@ void PluginProcessor::processBlock(juce::AudioBuffer<float> &buffer,
     noteGenerator->processIncomingMidi(
             midiMessages, processedMidi, buffer.getNumSamples());
 
-    if (sampleManager->isSampleLoaded()) {
+    // Removed samples keep sounding until their notes end, so keep rendering while voices are active
+    if (sampleManager->isSampleLoaded() || sampleManager->hasActiveVoices()) {
         sampleManager->processAudio(buffer, processedMidi);
         fxEngine->processAudio(buffer, processedMidi);
 
-        if (auto *editor = activeEditorPtr.getComponent()) {
-            if (buffer.getNumChannels() > 0 && buffer.getNumSamples() > 0) {
-                editor->setWaveformAudioBuffer(buffer.getReadPointer(0), buffer.getNumSamples());
-            }
+        // Peaks for the scrolling waveform, popped by the editor whenever it is open
+        if (buffer.getNumChannels() > 0 && buffer.getNumSamples() > 0) {
+            outputPeaks.push(buffer.getReadPointer(0), buffer.getNumSamples(), getSampleRate());
         }
 
     } else {
@@ -149,6 +158,11 @@ void PluginProcessor::getStateInformation(juce::MemoryBlock &destData) {
     directionXml->setAttribute("type", static_cast<int>(getSampleDirectionType()));
     mainXml->addChildElement(directionXml);
 
+    // Seed for the random decisions, restoring it replays the same take
+    auto *randomXml = new juce::XmlElement("Random");
+    randomXml->setAttribute("seed", juce::String::toHexString(static_cast<juce::int64>(randomService->getSeed())));
+    mainXml->addChildElement(randomXml);
+
     // Add sample information to the XML
     auto *samplesXml = new juce::XmlElement("Samples");
 
@@ -266,6 +280,10 @@ void PluginProcessor::setStateInformation(const void *data, int sizeInBytes) {
             }
         }
 
+        if (juce::XmlElement *randomXml = xmlState->getChildByName("Random")) {
+            randomService->setSeed(static_cast<std::uint64_t>(randomXml->getStringAttribute("seed").getHexValue64()));
+        }
+
         // Now look for samples
         if (juce::XmlElement *samplesXml = xmlState->getChildByName("Samples")) {
             // Get sample manager reference
@@ -296,9 +314,7 @@ void PluginProcessor::setStateInformation(const void *data, int sizeInBytes) {
                                     float startMarker = (float) sampleXml->getDoubleAttribute("startMarker", 0.0);
                                     float endMarker = (float) sampleXml->getDoubleAttribute("endMarker", 1.0);
 
-                                    if (auto *sound = sampleManager.getSampleSound(newSampleIndex)) {
-                                        sound->setMarkerPositions(startMarker, endMarker);
-                                    }
+                                    sampleManager.setSampleMarkerPositions(newSampleIndex, startMarker, endMarker);
                                 }
 
                                 // Set sample probability if it exists
@@ -7,6 +7,9 @@
 #include "Midi/NoteGenerator.h"
 #include "Sampler/SampleManager.h"
 #include "../Shared/ModulationMatrix.h"
+#include "../Shared/RandomService.h"
+#include "Util/PeakQueue.h"
+#include "Util/EngineEventQueue.h"
 #include <juce_gui_basics/juce_gui_basics.h>
 
 // Forward declarations
@@ -84,6 +87,14 @@ public:
 
     ModulationMatrix &getModulationMatrix() const { return *modMatrix; }
 
+    RandomService &getRandomService() const { return *randomService; }
+
+    // Min/max peaks of the output for the scrolling waveform, the editor is the only consumer
+    PeakQueue &getOutputPeaks() { return outputPeaks; }
+
+    // Notes and state changes of the engine for the editor, which is the only consumer
+    EngineEventQueue &getEngineEvents() { return engineEvents; }
+
     // Current state values for UI visualization
     float getCurrentRandomizedGate() const { return noteGenerator->getCurrentRandomizedGate(); }
 
@@ -97,12 +108,16 @@ private:
     juce::AudioProcessorValueTreeState apvts;
 
     // Specialized components for handling different aspects of the plugin
+    std::unique_ptr<RandomService> randomService;
     std::unique_ptr<ModulationMatrix> modMatrix;
     std::unique_ptr<NoteGenerator> noteGenerator;
     std::unique_ptr<SampleManager> sampleManager;
     std::unique_ptr<FxEngine> fxEngine;
     std::unique_ptr<TimingManager> timingManager;
 
+    PeakQueue outputPeaks;
+    EngineEventQueue engineEvents;
+
     // Safe pointer to the editor for thread-safe access from audio thread
     juce::Component::SafePointer<PluginEditor> activeEditorPtr;
 
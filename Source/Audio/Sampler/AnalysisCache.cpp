@@ -0,0 +1,182 @@
+#include "AnalysisCache.h"
+#include "OnsetDetector.h"
+#include <algorithm>
+#include <vector>
+
+namespace {
+    // Bump whenever the analysis or the file layout changes
+    constexpr int formatVersion = 2;
+}
+
+AnalysisCache::AnalysisCache() : AnalysisCache(getDefaultDirectory()) {}
+
+AnalysisCache::AnalysisCache(juce::File cacheDirectory) : directory(std::move(cacheDirectory)) {
+    trim();
+}
+
+juce::File AnalysisCache::getDefaultDirectory() {
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+            .getChildFile("Coincidence")
+            .getChildFile("AnalysisCache");
+}
+
+juce::String AnalysisCache::getSettingsKey() {
+    return "v" + juce::String(formatVersion)
+           + " frame=" + juce::String(OnsetDetector::frameSize)
+           + " hop=" + juce::String(OnsetDetector::hopSize)
+           + " threshold=" + juce::String(OnsetDetector::defaultThreshold)
+           + " sensitivity=" + juce::String(OnsetDetector::defaultSensitivity)
+           + " peaks=" + juce::String(PeakPyramid::baseFramesPerPeak);
+}
+
+namespace {
+    juce::String getSettingsSuffix() {
+        return "-" + juce::String::toHexString(AnalysisCache::getSettingsKey().hashCode64());
+    }
+}
+
+juce::File AnalysisCache::getEntryFile(const juce::String &contentHash) const {
+    // Content hashes end in ":<size>", which is not a valid file name everywhere
+    return directory.getChildFile(contentHash.replaceCharacter(':', '_') + getSettingsSuffix() + ".analysis");
+}
+
+SampleAnalysis::Ptr AnalysisCache::load(const juce::String &contentHash) const {
+    if (contentHash.isEmpty()) {
+        return nullptr;
+    }
+
+    const auto file = getEntryFile(contentHash);
+    SampleAnalysis::Ptr analysis;
+    {
+        juce::FileInputStream input(file);
+        if (!input.openedOk()) {
+            return nullptr;
+        }
+        analysis = readEntry(input);
+    }
+
+    if (analysis == nullptr) {
+        // Another version or a damaged file, it would only be read and rejected again
+        file.deleteFile();
+        return nullptr;
+    }
+
+    // Trimming goes by access time, which not every file system keeps up to date
+    file.setLastAccessTime(juce::Time::getCurrentTime());
+    return analysis;
+}
+
+SampleAnalysis::Ptr AnalysisCache::readEntry(juce::InputStream &input) {
+    if (input.readInt() != magicNumber || input.readString() != getSettingsKey()) {
+        return nullptr;
+    }
+
+    SampleAnalysis::Ptr analysis(new SampleAnalysis());
+
+    const int numMarkers = input.readInt();
+    if (numMarkers < 0 || numMarkers > 1 << 20) {
+        return nullptr;
+    }
+    analysis->onsetMarkers.resize(static_cast<size_t>(numMarkers));
+    for (auto &marker: analysis->onsetMarkers) {
+        marker = input.readFloat();
+    }
+
+    analysis->loudness.peak = input.readFloat();
+    analysis->loudness.rms = input.readFloat();
+    analysis->loudness.maxShortTermRms = input.readFloat();
+
+    analysis->beatGrid.bpm = input.readDouble();
+    analysis->beatGrid.firstBeatFrame = input.readDouble();
+    analysis->beatGrid.confidence = input.readFloat();
+
+    if (!analysis->peaks.readFrom(input) || !input.isExhausted()) {
+        return nullptr;
+    }
+
+    return analysis;
+}
+
+void AnalysisCache::store(const juce::String &contentHash, const SampleAnalysis &analysis) const {
+    if (contentHash.isEmpty() || analysis.peaks.getNumChannels() == 0 || directory.createDirectory().failed()) {
+        return;
+    }
+
+    const auto file = getEntryFile(contentHash);
+    juce::TemporaryFile temporary(file);
+
+    {
+        juce::FileOutputStream output(temporary.getFile());
+        if (!output.openedOk()) {
+            return;
+        }
+
+        output.writeInt(magicNumber);
+        output.writeString(getSettingsKey());
+
+        output.writeInt(static_cast<int>(analysis.onsetMarkers.size()));
+        for (float marker: analysis.onsetMarkers) {
+            output.writeFloat(marker);
+        }
+
+        output.writeFloat(analysis.loudness.peak);
+        output.writeFloat(analysis.loudness.rms);
+        output.writeFloat(analysis.loudness.maxShortTermRms);
+
+        output.writeDouble(analysis.beatGrid.bpm);
+        output.writeDouble(analysis.beatGrid.firstBeatFrame);
+        output.writeFloat(analysis.beatGrid.confidence);
+
+        analysis.peaks.writeTo(output);
+
+        output.flush();
+        if (output.getStatus().failed()) {
+            return;
+        }
+    }
+
+    if (temporary.overwriteTargetFileWithTemporary()
+        && cacheBytes.fetch_add(file.getSize()) + file.getSize() > maxCacheBytes) {
+        trim();
+    }
+}
+
+void AnalysisCache::trim() const {
+    const juce::ScopedLock sl(trimLock);
+
+    const auto suffix = getSettingsSuffix();
+    std::vector<std::pair<juce::Time, juce::File>> entries;
+    juce::int64 totalBytes = 0;
+
+    for (const auto &entry: juce::RangedDirectoryIterator(directory, false, "*.analysis")) {
+        const auto &file = entry.getFile();
+        const auto name = file.getFileNameWithoutExtension();
+
+        // Entries being written by another thread
+        if (name.contains("_temp")) {
+            continue;
+        }
+
+        if (!name.endsWith(suffix)) {
+            file.deleteFile();
+            continue;
+        }
+
+        entries.emplace_back(file.getLastAccessTime(), file);
+        totalBytes += entry.getFileSize();
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+
+    for (const auto &[lastAccess, file]: entries) {
+        if (totalBytes <= maxCacheBytes) {
+            break;
+        }
+        const auto size = file.getSize();
+        if (file.deleteFile()) {
+            totalBytes -= size;
+        }
+    }
+
+    cacheBytes.store(totalBytes);
+}
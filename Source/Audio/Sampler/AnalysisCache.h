@@ -0,0 +1,50 @@
+#pragma once
+
+#include <juce_audio_utils/juce_audio_utils.h>
+#include "SampleAnalysis.h"
+#include <atomic>
+
+/**
+ * Sample analyses kept on disk between sessions, one file per sample content hash in the
+ * user's application data folder. Entries record the analysis settings they were made
+ * with and are deleted once those change. The folder is kept under maxCacheBytes by
+ * deleting the entries used least recently. Reach it through a juce::SharedResourcePointer,
+ * any thread may load and store.
+ */
+class AnalysisCache {
+public:
+    AnalysisCache();
+
+    explicit AnalysisCache(juce::File cacheDirectory);
+
+    static juce::File getDefaultDirectory();
+
+    // Size the folder is trimmed back to, a few thousand samples' worth of entries
+    static constexpr juce::int64 maxCacheBytes = 256 * 1024 * 1024;
+
+    // Describes the detector and pyramid settings, an entry only matches the settings it was made with
+    static juce::String getSettingsKey();
+
+    // nullptr if nothing usable is stored for contentHash. An entry that cannot be read back
+    // with the current settings is deleted
+    [[nodiscard]] SampleAnalysis::Ptr load(const juce::String &contentHash) const;
+
+    // Writes to a temporary file first, so a reader never sees half an entry
+    void store(const juce::String &contentHash, const SampleAnalysis &analysis) const;
+
+    // Deletes entries made with other settings, then the least recently used ones until the
+    // folder fits in maxCacheBytes. Runs when the cache is created and whenever a store
+    // takes the folder over the limit
+    void trim() const;
+
+private:
+    static constexpr int magicNumber = 0x43414e41; // "ANAC"
+
+    juce::File directory;
+    mutable std::atomic<juce::int64> cacheBytes{0}; // Running estimate between trims
+    mutable juce::CriticalSection trimLock;
+
+    [[nodiscard]] juce::File getEntryFile(const juce::String &contentHash) const;
+
+    [[nodiscard]] static SampleAnalysis::Ptr readEntry(juce::InputStream &input);
+};
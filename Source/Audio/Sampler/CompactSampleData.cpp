@@ -0,0 +1,226 @@
+#include "CompactSampleData.h"
+#include <cmath>
+#include <cstring>
+
+#if JUCE_USE_SSE_INTRINSICS
+ #include <emmintrin.h>
+#elif JUCE_USE_ARM_NEON
+ #include <arm_neon.h>
+#endif
+
+namespace {
+    // Integer sources are read back exactly the way JUCE scales them to float
+    constexpr float int16Scale = 1.0f / 32768.0f;
+
+    // Half exponents are rebiased by this much, in float exponent units
+    constexpr std::uint32_t halfExponentRebias = (127 - 15) << 23;
+
+    // 2^-14, the smallest normal half
+    constexpr std::uint32_t smallestNormalHalfBits = 0x38800000u;
+}
+
+CompactSampleData::Format CompactSampleData::chooseFormat(const juce::AudioFormatReader &reader) {
+    return (reader.usesFloatingPointData || reader.bitsPerSample > 16) ? Format::Half : Format::Int16;
+}
+
+bool CompactSampleData::loadFrom(juce::AudioFormatReader &reader, Format newFormat, int maxChannels) {
+    const int numChannelsToLoad = juce::jmin(static_cast<int>(reader.numChannels), maxChannels);
+    if (numChannelsToLoad <= 0 || reader.lengthInSamples <= 0) {
+        return false;
+    }
+
+    format = newFormat;
+    numFrames = reader.lengthInSamples;
+
+    std::vector<juce::Range<float>> levels(static_cast<size_t>(numChannelsToLoad));
+    reader.readMaxLevels(0, numFrames, levels.data(), numChannelsToLoad);
+    peak = 0.0f;
+    for (const auto &level: levels) {
+        peak = juce::jmax(peak, -level.getStart(), level.getEnd());
+    }
+
+    // Half floats are stored relative to the peak, int16 keeps the source's own scale
+    const float encodeScale = (format == Format::Int16 || peak <= 0.0f) ? 1.0f : 1.0f / peak;
+    decodeScale = (format == Format::Int16) ? int16Scale : (peak > 0.0f ? peak : 1.0f);
+
+    channels.assign(static_cast<size_t>(numChannelsToLoad), std::vector<std::uint16_t>(static_cast<size_t>(numFrames)));
+
+    juce::AudioBuffer<float> block(numChannelsToLoad, loadBlockFrames);
+
+    for (juce::int64 start = 0; start < numFrames; start += loadBlockFrames) {
+        const int blockFrames = static_cast<int>(juce::jmin<juce::int64>(loadBlockFrames, numFrames - start));
+        if (!reader.read(&block, 0, blockFrames, start, true, numChannelsToLoad > 1)) {
+            return false;
+        }
+
+        for (int channel = 0; channel < numChannelsToLoad; ++channel) {
+            const float *input = block.getReadPointer(channel);
+            std::uint16_t *output = channels[static_cast<size_t>(channel)].data() + start;
+
+            if (format == Format::Int16) {
+                for (int frame = 0; frame < blockFrames; ++frame) {
+                    const auto value = juce::jlimit(-32768L, 32767L, std::lrint(input[frame] * 32768.0f));
+                    output[frame] = static_cast<std::uint16_t>(static_cast<std::int16_t>(value));
+                }
+            } else {
+                for (int frame = 0; frame < blockFrames; ++frame) {
+                    output[frame] = floatToHalf(input[frame] * encodeScale);
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+size_t CompactSampleData::getSizeInBytes() const {
+    return channels.size() * static_cast<size_t>(numFrames) * sizeof(std::uint16_t);
+}
+
+void CompactSampleData::decode(int channel, juce::int64 startFrame, int numFramesToDecode, float *destination) const {
+    jassert(channel >= 0 && channel < getNumChannels());
+    jassert(startFrame >= 0 && startFrame + numFramesToDecode <= numFrames);
+
+    const std::uint16_t *source = channels[static_cast<size_t>(channel)].data() + startFrame;
+
+    if (format == Format::Int16) {
+        decodeInt16(source, destination, decodeScale, numFramesToDecode);
+    } else {
+        decodeHalf(source, destination, decodeScale, numFramesToDecode);
+    }
+}
+
+void CompactSampleData::decodeInt16(const std::uint16_t *source, float *destination, float scale, int numFramesToDecode) {
+    int frame = 0;
+
+#if JUCE_USE_SSE_INTRINSICS
+    const __m128 scaleVector = _mm_set1_ps(scale);
+    for (; frame + 8 <= numFramesToDecode; frame += 8) {
+        const __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + frame));
+
+        // Each word lands in the top half of a lane, the arithmetic shift sign-extends it
+        const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(words, words), 16);
+        const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(words, words), 16);
+
+        _mm_storeu_ps(destination + frame, _mm_mul_ps(_mm_cvtepi32_ps(low), scaleVector));
+        _mm_storeu_ps(destination + frame + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scaleVector));
+    }
+#elif JUCE_USE_ARM_NEON
+    const float32x4_t scaleVector = vdupq_n_f32(scale);
+    for (; frame + 8 <= numFramesToDecode; frame += 8) {
+        const int16x8_t words = vreinterpretq_s16_u16(vld1q_u16(source + frame));
+
+        vst1q_f32(destination + frame, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(words))), scaleVector));
+        vst1q_f32(destination + frame + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(words))), scaleVector));
+    }
+#endif
+
+    for (; frame < numFramesToDecode; ++frame) {
+        destination[frame] = static_cast<float>(static_cast<std::int16_t>(source[frame])) * scale;
+    }
+}
+
+void CompactSampleData::decodeHalf(const std::uint16_t *source, float *destination, float scale, int numFramesToDecode) {
+    int frame = 0;
+
+    // Rebiasing the exponent turns a half into a float. Subnormal halves get one more exponent
+    // step and have the implicit bit subtracted again, which never produces a float denormal,
+    // so the result stays right under flush-to-zero
+#if JUCE_USE_SSE_INTRINSICS
+    const __m128 scaleVector = _mm_set1_ps(scale);
+    const __m128i magnitudeMask = _mm_set1_epi32(0x7fff);
+    const __m128i signMask = _mm_set1_epi32(0x8000);
+    const __m128i exponentMask = _mm_set1_epi32(0x7c00);
+    const __m128i rebias = _mm_set1_epi32(static_cast<int>(halfExponentRebias));
+    const __m128i exponentStep = _mm_set1_epi32(1 << 23);
+    const __m128 smallestNormal = _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(smallestNormalHalfBits)));
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; frame + 4 <= numFramesToDecode; frame += 4) {
+        const __m128i words = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(source + frame)), zero);
+
+        const __m128i bits = _mm_add_epi32(_mm_slli_epi32(_mm_and_si128(words, magnitudeMask), 13), rebias);
+        const __m128 normal = _mm_castsi128_ps(bits);
+        const __m128 subnormal = _mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(bits, exponentStep)), smallestNormal);
+        const __m128 isSubnormal = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(words, exponentMask), zero));
+
+        __m128 value = _mm_or_ps(_mm_and_ps(isSubnormal, subnormal), _mm_andnot_ps(isSubnormal, normal));
+        value = _mm_or_ps(value, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(words, signMask), 16)));
+
+        _mm_storeu_ps(destination + frame, _mm_mul_ps(value, scaleVector));
+    }
+#elif JUCE_USE_ARM_NEON
+    const float32x4_t scaleVector = vdupq_n_f32(scale);
+    const uint32x4_t magnitudeMask = vdupq_n_u32(0x7fff);
+    const uint32x4_t signMask = vdupq_n_u32(0x8000);
+    const uint32x4_t exponentMask = vdupq_n_u32(0x7c00);
+    const uint32x4_t rebias = vdupq_n_u32(halfExponentRebias);
+    const uint32x4_t exponentStep = vdupq_n_u32(1u << 23);
+    const float32x4_t smallestNormal = vreinterpretq_f32_u32(vdupq_n_u32(smallestNormalHalfBits));
+
+    for (; frame + 4 <= numFramesToDecode; frame += 4) {
+        const uint32x4_t words = vmovl_u16(vld1_u16(source + frame));
+
+        const uint32x4_t bits = vaddq_u32(vshlq_n_u32(vandq_u32(words, magnitudeMask), 13), rebias);
+        const float32x4_t normal = vreinterpretq_f32_u32(bits);
+        const float32x4_t subnormal = vsubq_f32(vreinterpretq_f32_u32(vaddq_u32(bits, exponentStep)), smallestNormal);
+        const uint32x4_t isSubnormal = vceqq_u32(vandq_u32(words, exponentMask), vdupq_n_u32(0));
+
+        uint32x4_t value = vbslq_u32(isSubnormal, vreinterpretq_u32_f32(subnormal), vreinterpretq_u32_f32(normal));
+        value = vorrq_u32(value, vshlq_n_u32(vandq_u32(words, signMask), 16));
+
+        vst1q_f32(destination + frame, vmulq_f32(vreinterpretq_f32_u32(value), scaleVector));
+    }
+#endif
+
+    for (; frame < numFramesToDecode; ++frame) {
+        destination[frame] = halfToFloat(source[frame]) * scale;
+    }
+}
+
+std::uint16_t CompactSampleData::floatToHalf(float value) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    const auto sign = static_cast<std::uint16_t>((bits >> 16) & 0x8000u);
+    const std::uint32_t magnitude = bits & 0x7fffffffu;
+
+    // Too large for a half, data is normalised so this only catches infinities and NaNs
+    if (magnitude >= 0x47800000u) {
+        return static_cast<std::uint16_t>(sign | (magnitude > 0x7f800000u ? 0x7e00u : 0x7c00u));
+    }
+
+    // Below the smallest normal half, the subnormal mantissa counts steps of 2^-24
+    if (magnitude < smallestNormalHalfBits) {
+        float absolute;
+        std::memcpy(&absolute, &magnitude, sizeof(absolute));
+        return static_cast<std::uint16_t>(sign | static_cast<std::uint16_t>(std::lrint(absolute * 16777216.0f)));
+    }
+
+    // Rebias the exponent and round the mantissa to nearest even, a carry rolls into the exponent
+    std::uint32_t half = (magnitude - halfExponentRebias) >> 13;
+    const std::uint32_t remainder = magnitude & 0x1fffu;
+    if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u) != 0)) {
+        ++half;
+    }
+
+    return static_cast<std::uint16_t>(sign | half);
+}
+
+float CompactSampleData::halfToFloat(std::uint16_t half) {
+    const std::uint32_t sign = static_cast<std::uint32_t>(half & 0x8000u) << 16;
+    const std::uint32_t bits = (static_cast<std::uint32_t>(half & 0x7fffu) << 13) + halfExponentRebias;
+
+    float value;
+    if ((half & 0x7c00u) == 0) {
+        const std::uint32_t shifted = bits + (1u << 23);
+        float smallestNormal;
+        std::memcpy(&value, &shifted, sizeof(value));
+        std::memcpy(&smallestNormal, &smallestNormalHalfBits, sizeof(smallestNormal));
+        value -= smallestNormal;
+    } else {
+        std::memcpy(&value, &bits, sizeof(value));
+    }
+
+    return sign != 0 ? -value : value;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <juce_audio_utils/juce_audio_utils.h>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Sample frames held as 16-bit words instead of floats, half the memory of an AudioBuffer.
+ * Integer sources of up to 16 bits are stored losslessly as int16. Deeper and floating point
+ * sources use half floats, which keep their dynamic range at about 11 bits of precision.
+ * Both are normalised to the sample's peak and decoded back to float with SIMD.
+ */
+class CompactSampleData {
+public:
+    enum class Format {
+        Int16,
+        Half
+    };
+
+    CompactSampleData() = default;
+
+    // The format that stores the reader's data with the least loss
+    static Format chooseFormat(const juce::AudioFormatReader &reader);
+
+    // Reads up to maxChannels channels of the whole file, converting block by block so the
+    // float data never exists in full. Must not be called from the audio thread
+    bool loadFrom(juce::AudioFormatReader &reader, Format newFormat, int maxChannels);
+
+    [[nodiscard]] Format getFormat() const { return format; }
+
+    [[nodiscard]] int getNumChannels() const { return static_cast<int>(channels.size()); }
+
+    [[nodiscard]] juce::int64 getNumFrames() const { return numFrames; }
+
+    // Absolute peak of the source, the stored words are relative to it
+    [[nodiscard]] float getPeak() const { return peak; }
+
+    [[nodiscard]] size_t getSizeInBytes() const;
+
+    // Decodes numFrames frames of one channel to float, the whole range must be inside the data
+    void decode(int channel, juce::int64 startFrame, int numFrames, float *destination) const;
+
+private:
+    static constexpr int loadBlockFrames = 65536;
+
+    Format format = Format::Int16;
+    juce::int64 numFrames = 0;
+    float peak = 0.0f;
+    float decodeScale = 1.0f;
+    std::vector<std::vector<std::uint16_t>> channels;
+
+    static void decodeInt16(const std::uint16_t *source, float *destination, float scale, int numFrames);
+
+    static void decodeHalf(const std::uint16_t *source, float *destination, float scale, int numFrames);
+
+    static std::uint16_t floatToHalf(float value);
+
+    static float halfToFloat(std::uint16_t half);
+};
@@ -0,0 +1,266 @@
+#include "Interpolator.h"
+
+#if JUCE_USE_SSE_INTRINSICS
+ #include <xmmintrin.h>
+#elif JUCE_USE_ARM_NEON
+ #include <arm_neon.h>
+#endif
+
+namespace {
+    // Linear and Hermite gather at most four taps
+    constexpr int maxGatheredTaps = 4;
+
+    // Cutoff at unity ratio as a fraction of Nyquist, leaves room for the window's transition band
+    constexpr double sincCutoff = 0.9;
+
+    static_assert(Interpolator::sincTaps == 8, "The sinc dot product is unrolled for 8 taps");
+
+    float dotProduct8(const float *samples, const float *coefficients) {
+#if JUCE_USE_SSE_INTRINSICS
+        __m128 sum = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(samples), _mm_loadu_ps(coefficients)),
+                                _mm_mul_ps(_mm_loadu_ps(samples + 4), _mm_loadu_ps(coefficients + 4)));
+        sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+        sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+        return _mm_cvtss_f32(sum);
+#elif JUCE_USE_ARM_NEON
+        const float32x4_t sum = vmlaq_f32(vmulq_f32(vld1q_f32(samples), vld1q_f32(coefficients)),
+                                          vld1q_f32(samples + 4), vld1q_f32(coefficients + 4));
+        const float32x2_t half = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+        return vget_lane_f32(vpadd_f32(half, half), 0);
+#else
+        float sum = 0.0f;
+        for (int tap = 0; tap < 8; ++tap) {
+            sum += samples[tap] * coefficients[tap];
+        }
+        return sum;
+#endif
+    }
+}
+
+void Interpolator::prepare(int maximumBlockSize) {
+    const auto size = static_cast<size_t>(std::max(maximumBlockSize, 1));
+
+    tapScratch.resize(maxGatheredTaps);
+    for (auto &tap: tapScratch) {
+        tap.assign(size, 0.0f);
+    }
+
+    accumulator.assign(size, 0.0f);
+    term.assign(size, 0.0f);
+
+    // Build the tables here rather than lazily on the first sinc render
+    for (int index = 0; index < numSincTables; ++index) {
+        getSincTable(index);
+    }
+}
+
+void Interpolator::setPlaybackRatio(double ratio) {
+    // The first table whose ratio covers this one, its cutoff is at or below the new Nyquist
+    sincTable = numSincTables - 1;
+    for (int index = 0; index < numSincTables; ++index) {
+        if (ratio <= sincTableRatios[index] + 1.0e-6) {
+            sincTable = index;
+            break;
+        }
+    }
+}
+
+void Interpolator::process(const float *source,
+                           int numSourceSamples,
+                           const int *positions,
+                           const float *fractions,
+                           float *destination,
+                           float gain,
+                           const float *envelope,
+                           int numFrames) {
+    if (numFrames <= 0 || numSourceSamples <= 0) {
+        return;
+    }
+
+    jassert(numFrames <= static_cast<int>(accumulator.size()));
+
+    switch (mode) {
+        case Models::INTERPOLATION_HERMITE:
+            processHermite(source, numSourceSamples, positions, fractions, numFrames);
+            break;
+        case Models::INTERPOLATION_SINC:
+            processSinc(source, numSourceSamples, positions, fractions, numFrames);
+            break;
+        case Models::INTERPOLATION_LINEAR:
+        default:
+            processLinear(source, numSourceSamples, positions, fractions, numFrames);
+            break;
+    }
+
+    if (envelope != nullptr) {
+        juce::FloatVectorOperations::multiply(accumulator.data(), envelope, numFrames);
+    }
+
+    juce::FloatVectorOperations::addWithMultiply(destination, accumulator.data(), gain, numFrames);
+}
+
+void Interpolator::copy(const float *source, float *destination, float gain, const float *envelope, int numFrames) {
+    if (numFrames <= 0) {
+        return;
+    }
+
+    if (envelope == nullptr) {
+        juce::FloatVectorOperations::addWithMultiply(destination, source, gain, numFrames);
+        return;
+    }
+
+    jassert(numFrames <= static_cast<int>(accumulator.size()));
+
+    juce::FloatVectorOperations::multiply(accumulator.data(), source, envelope, numFrames);
+    juce::FloatVectorOperations::addWithMultiply(destination, accumulator.data(), gain, numFrames);
+}
+
+void Interpolator::gatherTap(const float *source,
+                             int numSourceSamples,
+                             const int *positions,
+                             int offset,
+                             float *tap,
+                             int numFrames) const {
+    const int lastIndex = numSourceSamples - 1;
+
+    for (int frame = 0; frame < numFrames; ++frame) {
+        tap[frame] = source[juce::jlimit(0, lastIndex, positions[frame] + offset)];
+    }
+}
+
+void Interpolator::processLinear(const float *source,
+                                 int numSourceSamples,
+                                 const int *positions,
+                                 const float *fractions,
+                                 int numFrames) {
+    float *y0 = accumulator.data();
+    float *y1 = tapScratch[0].data();
+
+    gatherTap(source, numSourceSamples, positions, 0, y0, numFrames);
+    gatherTap(source, numSourceSamples, positions, 1, y1, numFrames);
+
+    // y0 + alpha * (y1 - y0)
+    juce::FloatVectorOperations::subtract(y1, y0, numFrames);
+    juce::FloatVectorOperations::addWithMultiply(y0, y1, fractions, numFrames);
+}
+
+void Interpolator::processHermite(const float *source,
+                                  int numSourceSamples,
+                                  const int *positions,
+                                  const float *fractions,
+                                  int numFrames) {
+    float *ym1 = tapScratch[0].data();
+    float *y0 = tapScratch[1].data();
+    float *y1 = tapScratch[2].data();
+    float *y2 = tapScratch[3].data();
+    float *c3 = accumulator.data();
+    float *c2 = term.data();
+
+    gatherTap(source, numSourceSamples, positions, -1, ym1, numFrames);
+    gatherTap(source, numSourceSamples, positions, 0, y0, numFrames);
+    gatherTap(source, numSourceSamples, positions, 1, y1, numFrames);
+    gatherTap(source, numSourceSamples, positions, 2, y2, numFrames);
+
+    // 4-point, 3rd-order Hermite (Catmull-Rom):
+    // c3 = 0.5 * (y2 - ym1) + 1.5 * (y0 - y1)
+    juce::FloatVectorOperations::copy(c3, y2, numFrames);
+    juce::FloatVectorOperations::subtract(c3, ym1, numFrames);
+    juce::FloatVectorOperations::multiply(c3, 0.5f, numFrames);
+    juce::FloatVectorOperations::addWithMultiply(c3, y0, 1.5f, numFrames);
+    juce::FloatVectorOperations::addWithMultiply(c3, y1, -1.5f, numFrames);
+
+    // c2 = ym1 - 2.5 * y0 + 2 * y1 - 0.5 * y2
+    juce::FloatVectorOperations::copy(c2, ym1, numFrames);
+    juce::FloatVectorOperations::addWithMultiply(c2, y0, -2.5f, numFrames);
+    juce::FloatVectorOperations::addWithMultiply(c2, y1, 2.0f, numFrames);
+    juce::FloatVectorOperations::addWithMultiply(c2, y2, -0.5f, numFrames);
+
+    // c1 = 0.5 * (y1 - ym1), written over y2 which is no longer needed
+    float *c1 = y2;
+    juce::FloatVectorOperations::copy(c1, y1, numFrames);
+    juce::FloatVectorOperations::subtract(c1, ym1, numFrames);
+    juce::FloatVectorOperations::multiply(c1, 0.5f, numFrames);
+
+    // ((c3 * x + c2) * x + c1) * x + y0
+    juce::FloatVectorOperations::multiply(c3, fractions, numFrames);
+    juce::FloatVectorOperations::add(c3, c2, numFrames);
+    juce::FloatVectorOperations::multiply(c3, fractions, numFrames);
+    juce::FloatVectorOperations::add(c3, c1, numFrames);
+    juce::FloatVectorOperations::multiply(c3, fractions, numFrames);
+    juce::FloatVectorOperations::add(c3, y0, numFrames);
+}
+
+void Interpolator::processSinc(const float *source,
+                               int numSourceSamples,
+                               const int *positions,
+                               const float *fractions,
+                               int numFrames) {
+    const float *table = getSincTable(sincTable).data();
+    const int lastIndex = numSourceSamples - 1;
+    float *output = accumulator.data();
+
+    for (int frame = 0; frame < numFrames; ++frame) {
+        const int phase = static_cast<int>(fractions[frame] * static_cast<float>(sincPhases) + 0.5f);
+        const float *coefficients = table + phase * sincTaps;
+        const int firstTap = positions[frame] - maxTapsBefore;
+
+        // Taps and coefficients are both contiguous, only the edges of the source need clamping
+        if (firstTap >= 0 && firstTap + sincTaps - 1 <= lastIndex) {
+            output[frame] = dotProduct8(source + firstTap, coefficients);
+            continue;
+        }
+
+        float sum = 0.0f;
+        for (int tap = 0; tap < sincTaps; ++tap) {
+            sum += source[juce::jlimit(0, lastIndex, firstTap + tap)] * coefficients[tap];
+        }
+        output[frame] = sum;
+    }
+}
+
+const std::vector<float> &Interpolator::getSincTable(int index) {
+    const auto buildTable = [](double ratio) {
+        // Above unity the output's Nyquist is below the source's, the cutoff follows it down
+        const double cutoff = sincCutoff * std::min(1.0, 1.0 / ratio);
+        const double halfLength = sincTaps / 2.0;
+        std::vector<float> coefficients(static_cast<size_t>(sincTaps * (sincPhases + 1)), 0.0f);
+
+        for (int phase = 0; phase <= sincPhases; ++phase) {
+            const double fraction = static_cast<double>(phase) / sincPhases;
+            double sum = 0.0;
+            double values[sincTaps];
+
+            for (int tap = 0; tap < sincTaps; ++tap) {
+                // Distance of this tap from the interpolated point
+                const double x = static_cast<double>(tap - (sincTaps / 2 - 1)) - fraction;
+                const double arg = juce::MathConstants<double>::pi * cutoff * x;
+                const double sinc = std::abs(x) < 1.0e-9 ? 1.0 : std::sin(arg) / arg;
+
+                // Blackman-Harris window across the kernel span
+                const double t = (x + halfLength) / (2.0 * halfLength);
+                const double twoPiT = juce::MathConstants<double>::twoPi * t;
+                const double window = 0.35875 - 0.48829 * std::cos(twoPiT)
+                                      + 0.14128 * std::cos(2.0 * twoPiT)
+                                      - 0.01168 * std::cos(3.0 * twoPiT);
+
+                values[tap] = cutoff * sinc * window;
+                sum += values[tap];
+            }
+
+            // Normalise every phase to unity DC gain
+            for (int tap = 0; tap < sincTaps; ++tap) {
+                coefficients[static_cast<size_t>(phase * sincTaps + tap)] =
+                        static_cast<float>(values[tap] / sum);
+            }
+        }
+
+        return coefficients;
+    };
+
+    static const std::vector<float> tables[numSincTables] = {
+            buildTable(sincTableRatios[0]), buildTable(sincTableRatios[1]), buildTable(sincTableRatios[2]),
+            buildTable(sincTableRatios[3]), buildTable(sincTableRatios[4]), buildTable(sincTableRatios[5])
+    };
+
+    return tables[index];
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <vector>
+#include "../../Shared/Models.h"
+
+/**
+ * Block-based fractional-delay interpolation used by SamplerVoice.
+ * Linear and Hermite gather their taps for the whole block into scratch arrays and then
+ * evaluate the interpolation with vectorised FloatVectorOperations. Sinc evaluates each
+ * frame as one SSE/NEON dot product over contiguous taps, with its cutoff lowered as the
+ * playback ratio rises so pitching up does not alias.
+ */
+class Interpolator {
+public:
+    // Sinc kernel length and the number of fractional phases stored per tap
+    static constexpr int sincTaps = 8;
+    static constexpr int sincPhases = 1024;
+
+    // Playback ratios a sinc table is built for, each is used up to its ratio
+    static constexpr int numSincTables = 6;
+    static constexpr double sincTableRatios[numSincTables] = {1.0, 1.25, 1.5, 2.0, 3.0, 4.0};
+
+    // Widest reach of any mode around a position, callers that hand over a window of the
+    // source must include this many frames before and after the positions they render
+    static constexpr int maxTapsBefore = sincTaps / 2 - 1;
+    static constexpr int maxTapsAfter = sincTaps / 2;
+
+    Interpolator() = default;
+
+    // Sizes the scratch buffers and builds the shared sinc tables, must not be called from the audio thread
+    void prepare(int maximumBlockSize);
+
+    void setMode(Models::InterpolationMode newMode) { mode = newMode; }
+
+    // Source frames advanced per output frame, picks the sinc table whose cutoff suits it
+    void setPlaybackRatio(double ratio);
+
+    [[nodiscard]] Models::InterpolationMode getMode() const { return mode; }
+
+    /**
+     * Interpolates numFrames output samples and adds them, scaled by gain, to destination.
+     * @param source Source channel, reads outside [0, numSourceSamples) are clamped to the edges
+     * @param positions Integer source position for every output frame
+     * @param fractions Fractional offset (0.0-1.0) from each integer position
+     * @param envelope Optional per-frame gain applied on top of gain, may be nullptr
+     */
+    void process(const float *source,
+                 int numSourceSamples,
+                 const int *positions,
+                 const float *fractions,
+                 float *destination,
+                 float gain,
+                 const float *envelope,
+                 int numFrames);
+
+    /**
+     * Unity-ratio playback from whole-sample positions, where there is nothing to interpolate.
+     * Adds numFrames consecutive source samples, scaled by gain and the optional envelope.
+     */
+    void copy(const float *source, float *destination, float gain, const float *envelope, int numFrames);
+
+private:
+    Models::InterpolationMode mode = Models::INTERPOLATION_LINEAR;
+
+    // Gathered taps and intermediate terms, one entry per output frame
+    std::vector<std::vector<float>> tapScratch;
+    std::vector<float> accumulator;
+    std::vector<float> term;
+    int sincTable = 0;
+
+    void gatherTap(const float *source, int numSourceSamples, const int *positions, int offset,
+                   float *tap, int numFrames) const;
+
+    void processLinear(const float *source, int numSourceSamples, const int *positions,
+                       const float *fractions, int numFrames);
+
+    void processHermite(const float *source, int numSourceSamples, const int *positions,
+                        const float *fractions, int numFrames);
+
+    void processSinc(const float *source, int numSourceSamples, const int *positions,
+                     const float *fractions, int numFrames);
+
+    // Phase-major table of windowed-sinc coefficients, sincTaps contiguous coefficients for each
+    // of the (sincPhases + 1) phases, with the cutoff lowered for sincTableRatios[index]
+    static const std::vector<float> &getSincTable(int index);
+};
@@ -0,0 +1,193 @@
+#include "LiveOnsetDetector.h"
+#include "OnsetDetector.h"
+
+namespace {
+    // Log compression keeps the flux comparable between quiet and loud playing
+    constexpr float magnitudeCompression = 100.0f;
+
+    // Per hop decay of the loudest recent flux, which onset strengths are measured against
+    constexpr float fluxPeakDecay = 0.9995f;
+}
+
+LiveOnsetDetector::LiveOnsetDetector()
+        : fft(fftOrder),
+          window(frameSize, juce::dsp::WindowingFunction<float>::hann),
+          history(historySize, 0.0f),
+          fftBuffer(frameSize * 2, 0.0f),
+          fluxDifference(numBins, 0.0f),
+          magnitudeSpectrum(numBins, 0.0f),
+          prevMagnitudeSpectrum(numBins, 0.0f),
+          recentFlux(thresholdFrames, 0.0f) {}
+
+void LiveOnsetDetector::prepare(double newSampleRate, int maximumBlockSize) {
+    sampleRate = newSampleRate;
+
+    // At most one onset per hop, the minimum interval usually allows far fewer
+    onsets.reserve(static_cast<size_t>(maximumBlockSize / hopSize + 2));
+
+    reset();
+}
+
+void LiveOnsetDetector::reset() {
+    std::fill(history.begin(), history.end(), 0.0f);
+    std::fill(prevMagnitudeSpectrum.begin(), prevMagnitudeSpectrum.end(), 0.0f);
+    std::fill(recentFlux.begin(), recentFlux.end(), 0.0f);
+    hopFill = 0;
+    recentFluxIndex = 0;
+    numRecentFlux = 0;
+    recentFluxSum = 0.0;
+    previousFlux = olderFlux = fluxPeak = 0.0f;
+    samplesProcessed = 0;
+    lastOnsetPosition = std::numeric_limits<juce::int64>::min() / 2;
+    onsets.clear();
+}
+
+void LiveOnsetDetector::process(const juce::AudioBuffer<float> &input, int numChannels, int numSamples) {
+    onsets.clear();
+
+    const juce::int64 blockStart = samplesProcessed;
+    numChannels = juce::jmin(numChannels, input.getNumChannels());
+
+    int consumed = 0;
+    while (consumed < numSamples) {
+        const int numToCopy = juce::jmin(hopSize - hopFill, numSamples - consumed);
+        float *destination = history.data() + historySize - hopSize + hopFill;
+
+        // Mono mix of the input channels, silence when the bus is disabled
+        if (numChannels > 0) {
+            juce::FloatVectorOperations::copy(destination, input.getReadPointer(0, consumed), numToCopy);
+            for (int channel = 1; channel < numChannels; ++channel) {
+                juce::FloatVectorOperations::add(destination, input.getReadPointer(channel, consumed), numToCopy);
+            }
+            if (numChannels > 1) {
+                juce::FloatVectorOperations::multiply(destination, 1.0f / static_cast<float>(numChannels), numToCopy);
+            }
+        } else {
+            juce::FloatVectorOperations::clear(destination, numToCopy);
+        }
+
+        hopFill += numToCopy;
+        consumed += numToCopy;
+
+        if (hopFill == hopSize) {
+            analyseFrame(blockStart + consumed, blockStart);
+
+            // Make room for the next hop
+            std::copy(history.begin() + hopSize, history.end(), history.begin());
+            hopFill = 0;
+        }
+    }
+
+    samplesProcessed += numSamples;
+}
+
+void LiveOnsetDetector::analyseFrame(juce::int64 historyEnd, juce::int64 blockStart) {
+    const float flux = computeFlux();
+
+    // Threshold from the frames before the candidate, so a hit does not raise its own bar
+    const float average = static_cast<float>(recentFluxSum / juce::jmax(1, numRecentFlux));
+    const float multiplier = juce::jmap(sensitivity, 2.0f, 0.25f);
+    const float offset = juce::jmap(sensitivity, 0.2f, 0.01f);
+    const float threshold = average * (1.0f + multiplier) + offset;
+
+    fluxPeak = juce::jmax(previousFlux, fluxPeak * fluxPeakDecay);
+
+    // The previous frame is a peak once this one is no higher. Nothing is picked until the
+    // average has seen enough of the input's noise floor
+    if (numRecentFlux >= minimumThresholdFrames && previousFlux > threshold && previousFlux > olderFlux && previousFlux >= flux) {
+        const juce::int64 position = findAttackStart(historyEnd);
+        const auto minimumInterval = static_cast<juce::int64>(minimumIntervalSeconds * sampleRate);
+
+        if (position - lastOnsetPosition >= minimumInterval) {
+            Onset onset;
+            onset.position = position;
+            onset.sampleOffset = static_cast<int>(juce::jmax<juce::int64>(0, position - blockStart));
+            onset.strength = fluxPeak > 0.0f ? juce::jlimit(0.0f, 1.0f, previousFlux / fluxPeak) : 1.0f;
+            onsets.push_back(onset);
+
+            lastOnsetPosition = position;
+        }
+    }
+
+    recentFluxSum += previousFlux - recentFlux[static_cast<size_t>(recentFluxIndex)];
+    recentFlux[static_cast<size_t>(recentFluxIndex)] = previousFlux;
+    recentFluxIndex = (recentFluxIndex + 1) % thresholdFrames;
+    numRecentFlux = juce::jmin(numRecentFlux + 1, thresholdFrames);
+
+    olderFlux = previousFlux;
+    previousFlux = flux;
+}
+
+float LiveOnsetDetector::computeFlux() {
+    juce::FloatVectorOperations::copy(fftBuffer.data(), history.data() + historySize - frameSize, frameSize);
+    juce::FloatVectorOperations::clear(fftBuffer.data() + frameSize, frameSize);
+
+    window.multiplyWithWindowingTable(fftBuffer.data(), frameSize);
+    fft.performRealOnlyForwardTransform(fftBuffer.data(), true);
+
+    // Same SIMD magnitudes as the offline detector, straight from the interleaved bins
+    float *magnitudes = magnitudeSpectrum.data();
+    OnsetDetector::computeMagnitudes(fftBuffer.data(), magnitudes, numBins);
+
+    for (int bin = 0; bin < numBins; ++bin) {
+        magnitudes[bin] = std::log1p(magnitudeCompression * magnitudes[bin]);
+    }
+
+    // Half-wave rectified difference, averaged over the bins
+    float *difference = fluxDifference.data();
+    juce::FloatVectorOperations::subtract(difference, magnitudes, prevMagnitudeSpectrum.data(), numBins);
+    juce::FloatVectorOperations::max(difference, difference, 0.0f, numBins);
+
+    float flux = 0.0f;
+    for (int bin = 0; bin < numBins; ++bin) {
+        flux += difference[bin];
+    }
+
+    std::swap(magnitudeSpectrum, prevMagnitudeSpectrum);
+    return flux / static_cast<float>(numBins);
+}
+
+juce::int64 LiveOnsetDetector::findAttackStart(juce::int64 historyEnd) const {
+    const juce::int64 historyStart = historyEnd - historySize;
+
+    // Peak amplitude of each short block of the history, never looking back past the last onset
+    constexpr int numBlocks = historySize / envelopeBlockSize;
+    float envelope[numBlocks];
+    const int firstBlock = static_cast<int>(juce::jlimit<juce::int64>(
+            0, numBlocks - 1, (lastOnsetPosition - historyStart) / envelopeBlockSize + 1));
+
+    int loudestBlock = firstBlock;
+    for (int block = firstBlock; block < numBlocks; ++block) {
+        const auto range = juce::FloatVectorOperations::findMinAndMax(
+                history.data() + block * envelopeBlockSize, envelopeBlockSize);
+        envelope[block] = juce::jmax(-range.getStart(), range.getEnd());
+        if (envelope[block] > envelope[loudestBlock]) {
+            loudestBlock = block;
+        }
+    }
+
+    // The quietest block before the loudest one is the floor the attack rises from
+    int quietestBlock = loudestBlock;
+    for (int block = firstBlock; block < loudestBlock; ++block) {
+        if (envelope[block] < envelope[quietestBlock]) {
+            quietestBlock = block;
+        }
+    }
+
+    const float attackLevel = envelope[quietestBlock] + (envelope[loudestBlock] - envelope[quietestBlock]) * 0.3f;
+
+    for (int block = quietestBlock; block <= loudestBlock; ++block) {
+        if (envelope[block] >= attackLevel) {
+            // The first sample of that block to reach the attack level
+            const float *samples = history.data() + block * envelopeBlockSize;
+            for (int i = 0; i < envelopeBlockSize; ++i) {
+                if (std::abs(samples[i]) >= attackLevel) {
+                    return historyStart + block * envelopeBlockSize + i;
+                }
+            }
+            return historyStart + block * envelopeBlockSize;
+        }
+    }
+
+    return historyStart + loudestBlock * envelopeBlockSize;
+}
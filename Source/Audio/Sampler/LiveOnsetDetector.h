@@ -0,0 +1,88 @@
+#pragma once
+
+#include <juce_audio_utils/juce_audio_utils.h>
+#include <juce_dsp/juce_dsp.h>
+#include <limits>
+#include <vector>
+
+/**
+ * Block-driven onset detector for live input. Runs one short FFT per hop of incoming audio,
+ * so the cost of a block is bounded by its length, and picks peaks in the spectral flux
+ * causally against a running average. Onsets are reported a couple of hops after they
+ * happen, with their position refined to the sample from the input history.
+ */
+class LiveOnsetDetector {
+public:
+    struct Onset {
+        juce::int64 position = 0; // Absolute input sample position
+        int sampleOffset = 0;     // Position within the block just processed, 0 if it began in an earlier block
+        float strength = 0.0f;    // 0-1, relative to recent onsets
+    };
+
+    static constexpr int fftOrder = 9;
+    static constexpr int frameSize = 1 << fftOrder;
+    static constexpr int hopSize = 128;
+
+    LiveOnsetDetector();
+
+    // Must not be called from the audio thread
+    void prepare(double sampleRate, int maximumBlockSize);
+
+    void reset();
+
+    // 0-1, higher finds quieter hits
+    void setSensitivity(float newSensitivity) { sensitivity = juce::jlimit(0.0f, 1.0f, newSensitivity); }
+
+    // Analyses the first numChannels channels of input mixed to mono. Replaces the onsets of the
+    // previous block. Audio thread, never allocates
+    void process(const juce::AudioBuffer<float> &input, int numChannels, int numSamples);
+
+    [[nodiscard]] int getNumOnsets() const { return static_cast<int>(onsets.size()); }
+
+    [[nodiscard]] const Onset &getOnset(int index) const { return onsets[static_cast<size_t>(index)]; }
+
+private:
+    static constexpr int numBins = frameSize / 2 + 1;
+    // Input kept for refining positions, an onset peaks in the flux up to two hops after it enters a frame
+    static constexpr int historySize = frameSize + 2 * hopSize;
+    static constexpr int envelopeBlockSize = 16;
+    static constexpr int thresholdFrames = 24;
+    static constexpr int minimumThresholdFrames = 4;
+    static constexpr double minimumIntervalSeconds = 0.05;
+
+    juce::dsp::FFT fft;
+    juce::dsp::WindowingFunction<float> window;
+
+    // The newest hop is gathered at the end of the history, frames are its last frameSize samples
+    std::vector<float> history;
+    int hopFill = 0;
+
+    std::vector<float> fftBuffer;
+    std::vector<float> fluxDifference;
+    std::vector<float> magnitudeSpectrum, prevMagnitudeSpectrum;
+
+    // Recent flux for the adaptive threshold, kept as a ring with its running sum
+    std::vector<float> recentFlux;
+    int recentFluxIndex = 0;
+    int numRecentFlux = 0;
+    double recentFluxSum = 0.0;
+    float previousFlux = 0.0f, olderFlux = 0.0f;
+    float fluxPeak = 0.0f;
+
+    float sensitivity = 0.5f;
+    double sampleRate = 44100.0;
+    juce::int64 samplesProcessed = 0;
+    juce::int64 lastOnsetPosition = std::numeric_limits<juce::int64>::min() / 2;
+
+    std::vector<Onset> onsets;
+
+    // Analyses the frame that ends at historyEnd, an absolute sample position
+    void analyseFrame(juce::int64 historyEnd, juce::int64 blockStart);
+
+    float computeFlux();
+
+    // Start of the attack within the history, as an absolute sample position
+    juce::int64 findAttackStart(juce::int64 historyEnd) const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LiveOnsetDetector)
+};
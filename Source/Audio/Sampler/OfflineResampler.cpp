@@ -0,0 +1,90 @@
+#include "OfflineResampler.h"
+#include <cmath>
+#include <vector>
+
+namespace {
+    // Kaiser window shape, around 90 dB of stopband attenuation
+    constexpr double kaiserBeta = 9.0;
+
+    // Passband edge as a fraction of the lower of the two Nyquist frequencies
+    constexpr double passband = 0.95;
+
+    double besselI0(double x) {
+        double sum = 1.0;
+        double term = 1.0;
+        for (int k = 1; k < 32; ++k) {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+            if (term < sum * 1.0e-12) {
+                break;
+            }
+        }
+        return sum;
+    }
+}
+
+void OfflineResampler::process(const juce::AudioBuffer<float> &source,
+                               double sourceRate,
+                               juce::AudioBuffer<float> &destination,
+                               double targetRate) {
+    const int numChannels = source.getNumChannels();
+    const int numSourceSamples = source.getNumSamples();
+
+    if (numChannels == 0 || numSourceSamples == 0 || sourceRate <= 0.0 || targetRate <= 0.0) {
+        destination.setSize(numChannels, 0);
+        return;
+    }
+
+    const double ratio = targetRate / sourceRate;
+    const int numOutputSamples = static_cast<int>(std::ceil(numSourceSamples * ratio));
+    destination.setSize(numChannels, numOutputSamples, false, false, true);
+
+    // Downsampling lowers the cutoff below the target's Nyquist, the kernel widens to match
+    const double cutoff = passband * std::min(1.0, ratio);
+    const double halfWidth = zeroCrossings / cutoff;
+
+    // One side of the symmetric kernel, in steps of 1 / tableResolution source samples
+    const int tableSize = static_cast<int>(std::ceil(halfWidth * tableResolution)) + 2;
+    std::vector<float> kernel(static_cast<size_t>(tableSize), 0.0f);
+    const double windowNorm = besselI0(kaiserBeta);
+
+    for (int i = 0; i < tableSize; ++i) {
+        const double t = static_cast<double>(i) / tableResolution;
+        if (t >= halfWidth) {
+            break;
+        }
+
+        const double x = juce::MathConstants<double>::pi * cutoff * t;
+        const double sinc = (i == 0) ? 1.0 : std::sin(x) / x;
+        const double w = t / halfWidth;
+        const double window = besselI0(kaiserBeta * std::sqrt(1.0 - w * w)) / windowNorm;
+        kernel[static_cast<size_t>(i)] = static_cast<float>(cutoff * sinc * window);
+    }
+
+    const int maxTaps = static_cast<int>(std::ceil(2.0 * halfWidth)) + 2;
+    std::vector<float> weights(static_cast<size_t>(maxTaps));
+
+    for (int out = 0; out < numOutputSamples; ++out) {
+        const double centre = out / ratio;
+        const int first = std::max(0, static_cast<int>(std::ceil(centre - halfWidth)));
+        const int last = std::min(numSourceSamples - 1, static_cast<int>(std::floor(centre + halfWidth)));
+        const int numTaps = last - first + 1;
+
+        for (int tap = 0; tap < numTaps; ++tap) {
+            const double index = std::abs(centre - (first + tap)) * tableResolution;
+            const int i = static_cast<int>(index);
+            const float fraction = static_cast<float>(index - i);
+            weights[static_cast<size_t>(tap)] = kernel[static_cast<size_t>(i)]
+                                                + fraction * (kernel[static_cast<size_t>(i + 1)] - kernel[static_cast<size_t>(i)]);
+        }
+
+        for (int channel = 0; channel < numChannels; ++channel) {
+            const float *input = source.getReadPointer(channel, first);
+            float sum = 0.0f;
+            for (int tap = 0; tap < numTaps; ++tap) {
+                sum += input[tap] * weights[static_cast<size_t>(tap)];
+            }
+            destination.setSample(channel, out, sum);
+        }
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+/**
+ * Windowed-sinc sample rate conversion of whole buffers.
+ * The kernel is far longer than the realtime Interpolator's and narrows its cutoff when
+ * downsampling, so it is meant to run once per sample on a background thread.
+ */
+class OfflineResampler {
+public:
+    // Zero crossings on each side of the kernel at full bandwidth
+    static constexpr int zeroCrossings = 32;
+
+    // Kernel table resolution, in entries per source sample
+    static constexpr int tableResolution = 512;
+
+    // Converts every channel of source from sourceRate to targetRate, destination is resized to fit
+    static void process(const juce::AudioBuffer<float> &source,
+                        double sourceRate,
+                        juce::AudioBuffer<float> &destination,
+                        double targetRate);
+};
@@ -3,131 +3,171 @@
 //
 
 #include "OnsetDetector.h"
+#include <cmath>
+
+#if JUCE_USE_SSE_INTRINSICS
+ #include <xmmintrin.h>
+#elif JUCE_USE_ARM_NEON && JUCE_64BIT
+ #include <arm_neon.h>
+#endif
 
 OnsetDetector::OnsetDetector()
+    : fft(fftOrder),
+      window(frameSize, juce::dsp::WindowingFunction<float>::hann),
+      fftBuffer(frameSize * 2, 0.0f), // Real and imaginary parts
+      fluxDifference(numBins, 0.0f),
+      magnitudeSpectrum(numBins, 0.0f),
+      prevMagnitudeSpectrum(numBins, 0.0f)
 {
 }
 
 std::vector<float> OnsetDetector::detectOnsets(const juce::AudioBuffer<float>& audioBuffer, double sampleRate)
 {
-    // Parameters for onset detection
-    int frameSize = 2048; // FFT frame size
-    int hopSize = 512;    // Hop size between frames
+    juce::ignoreUnused(sampleRate);
 
-    // Generate the detection function based on spectral difference
-    std::vector<float> detectionFunction = generateDetectionFunction(audioBuffer, hopSize, frameSize);
+    const int numSamples = audioBuffer.getNumSamples();
+    if (audioBuffer.getNumChannels() == 0)
+        return {};
 
-    // Find peaks in the detection function
-    std::vector<int> peakIndices = findPeaks(detectionFunction, detectionThreshold);
+    // Generate the detection function based on spectral difference (mono analysis for simplicity)
+    std::vector<float> detectionFunction(static_cast<size_t>(getNumDetectionFrames(numSamples)), 0.0f);
+    computeSpectralFlux(audioBuffer.getReadPointer(0), numSamples, 0,
+                        static_cast<int>(detectionFunction.size()), detectionFunction.data());
 
-    // Convert peak indices to normalized positions (0.0-1.0)
-    std::vector<float> onsets;
-    for (auto index : peakIndices)
+    return findOnsets(detectionFunction, numSamples);
+}
+
+int OnsetDetector::getNumDetectionFrames(int numSamples)
+{
+    return numSamples < frameSize ? 0 : (numSamples - frameSize) / hopSize + 1;
+}
+
+void OnsetDetector::computeSpectralFlux(const float* samples, int numSamples, int firstFrame, int numFrames, float* flux)
+{
+    // Silence before the first frame
+    juce::FloatVectorOperations::clear(prevMagnitudeSpectrum.data(), numBins);
+
+    // A chunk starts one frame early so its first difference matches the serial result
+    const int startFrame = firstFrame > 0 ? firstFrame - 1 : firstFrame;
+
+    for (int i = startFrame; i < firstFrame + numFrames; ++i)
     {
-        float normalizedPosition = static_cast<float>(index * hopSize) / audioBuffer.getNumSamples();
-        onsets.push_back(normalizedPosition);
-    }
+        computeMagnitudeSpectrum(samples, numSamples, i);
 
-    return onsets;
+        if (i >= firstFrame)
+            flux[i - firstFrame] = computeRectifiedFlux();
+
+        // This frame's spectrum is the next one's reference
+        std::swap(magnitudeSpectrum, prevMagnitudeSpectrum);
+    }
 }
 
-std::vector<float> OnsetDetector::generateDetectionFunction(const juce::AudioBuffer<float>& audioBuffer, int hopSize, int frameSize)
+void OnsetDetector::computeMagnitudeSpectrum(const float* samples, int numSamples, int frame)
 {
-    int numSamples = audioBuffer.getNumSamples();
-    int numFrames = (numSamples - frameSize) / hopSize + 1;
-    std::vector<float> detectionFunction(numFrames, 0.0f);
+    // Copy the frame into the FFT buffer, zero padding past the end of the samples
+    const int frameStart = frame * hopSize;
+    const int available = juce::jlimit(0, frameSize, numSamples - frameStart);
+    juce::FloatVectorOperations::copy(fftBuffer.data(), samples + frameStart, available);
+    juce::FloatVectorOperations::clear(fftBuffer.data() + available, frameSize * 2 - available);
 
-    // Create FFT objects for spectral analysis
-    juce::dsp::FFT fft(std::log2(frameSize));
-    std::vector<float> fftBuffer(frameSize * 2, 0.0f); // Real and imaginary parts
+    window.multiplyWithWindowingTable(fftBuffer.data(), frameSize);
+    fft.performRealOnlyForwardTransform(fftBuffer.data(), true);
 
-    // Create a Hann window for the FFT
-    juce::dsp::WindowingFunction<float> window(frameSize, juce::dsp::WindowingFunction<float>::hann);
+    computeMagnitudes(fftBuffer.data(), magnitudeSpectrum.data(), numBins);
+}
 
-    // Previous magnitude spectrum for comparison
-    std::vector<float> prevMagnitudeSpectrum(frameSize / 2 + 1, 0.0f);
+void OnsetDetector::computeMagnitudes(const float* interleavedBins, float* magnitudes, int numBins)
+{
+    int bin = 0;
 
-    // For each frame
-    for (int i = 0; i < numFrames; ++i)
+#if JUCE_USE_SSE_INTRINSICS
+    for (; bin + 4 <= numBins; bin += 4)
     {
-        // Copy audio data to FFT buffer (real part only)
-        for (int j = 0; j < frameSize; ++j)
-        {
-            int sampleIndex = i * hopSize + j;
-
-            if (sampleIndex < numSamples)
-            {
-                fftBuffer[j] = audioBuffer.getSample(0, sampleIndex); // Mono analysis for simplicity
-            }
-            else
-            {
-                fftBuffer[j] = 0.0f; // Zero padding
-            }
-        }
+        const __m128 first = _mm_loadu_ps(interleavedBins + bin * 2);
+        const __m128 second = _mm_loadu_ps(interleavedBins + bin * 2 + 4);
+        const __m128 re = _mm_shuffle_ps(first, second, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m128 im = _mm_shuffle_ps(first, second, _MM_SHUFFLE(3, 1, 3, 1));
 
-        // Apply window function
-        window.multiplyWithWindowingTable(fftBuffer.data(), frameSize);
+        _mm_storeu_ps(magnitudes + bin, _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im))));
+    }
+#elif JUCE_USE_ARM_NEON && JUCE_64BIT // vsqrtq_f32 is AArch64 only
+    for (; bin + 4 <= numBins; bin += 4)
+    {
+        const float32x4x2_t parts = vld2q_f32(interleavedBins + bin * 2); // Splits re and im
+        const float32x4_t squared = vmlaq_f32(vmulq_f32(parts.val[0], parts.val[0]), parts.val[1], parts.val[1]);
 
-        // Perform FFT
-        fft.performRealOnlyForwardTransform(fftBuffer.data());
+        vst1q_f32(magnitudes + bin, vsqrtq_f32(squared));
+    }
+#endif
 
-        // Calculate magnitude spectrum
-        std::vector<float> magnitudeSpectrum(frameSize / 2 + 1, 0.0f);
-        for (int j = 0; j < magnitudeSpectrum.size(); ++j)
-        {
-            float real = fftBuffer[j * 2];
-            float imag = fftBuffer[j * 2 + 1];
-            magnitudeSpectrum[j] = std::sqrt(real * real + imag * imag);
-        }
+    for (; bin < numBins; ++bin)
+    {
+        const float re = interleavedBins[bin * 2];
+        const float im = interleavedBins[bin * 2 + 1];
+        magnitudes[bin] = std::sqrt(re * re + im * im);
+    }
+}
 
-        // Calculate spectral difference (rectified)
-        float spectralDiff = 0.0f;
-        for (int j = 0; j < magnitudeSpectrum.size(); ++j)
-        {
-            // Apply the half-wave rectifier (only count increases in energy)
-            float diff = magnitudeSpectrum[j] - prevMagnitudeSpectrum[j];
-            if (diff > 0.0f)
-                spectralDiff += diff;
-        }
+float OnsetDetector::computeRectifiedFlux()
+{
+    // The half-wave rectifier only counts increases in energy
+    float* difference = fluxDifference.data();
+    juce::FloatVectorOperations::subtract(difference, magnitudeSpectrum.data(), prevMagnitudeSpectrum.data(), numBins);
+    juce::FloatVectorOperations::max(difference, difference, 0.0f, numBins);
 
-        // Store in detection function
-        detectionFunction[i] = spectralDiff;
+    float spectralDiff = 0.0f;
+    for (int j = 0; j < numBins; ++j)
+        spectralDiff += difference[j];
 
-        // Update previous magnitude spectrum
-        prevMagnitudeSpectrum = magnitudeSpectrum;
-    }
+    return spectralDiff;
+}
+
+std::vector<float> OnsetDetector::findOnsets(std::vector<float>& detectionFunction, int numSamples)
+{
+    if (detectionFunction.size() < 3 || numSamples <= 0)
+        return {};
 
     // Normalize the detection function
     normalizeBuffer(detectionFunction);
 
-    return detectionFunction;
-}
+    // Find peaks in the detection function
+    std::vector<int> peakIndices = findPeaks(detectionFunction, detectionThreshold);
 
+    // Convert peak indices to normalized positions (0.0-1.0)
+    std::vector<float> onsets;
+    for (auto index : peakIndices)
+    {
+        float normalizedPosition = static_cast<float>(index * hopSize) / numSamples;
+        onsets.push_back(normalizedPosition);
+    }
+
+    return onsets;
+}
 std::vector<int> OnsetDetector::findPeaks(const std::vector<float>& detectionFunction, float threshold)
 {
     std::vector<int> peaks;
 
-    // Moving average for adaptive thresholding
+    // Moving average for adaptive thresholding, a running sum over the window around each frame
     const int windowSize = 10;
-    std::vector<float> movingAverage(detectionFunction.size(), 0.0f);
+    const int size = static_cast<int>(detectionFunction.size());
+    movingAverage.resize(detectionFunction.size());
 
-    // Calculate moving average
-    for (int i = 0; i < detectionFunction.size(); ++i)
+    double windowSum = 0.0;
+    int windowStart = 0, windowEnd = 0;
+
+    for (int i = 0; i < size; ++i)
     {
-        float sum = 0.0f;
-        int count = 0;
+        for (const int end = std::min(size, i + windowSize / 2 + 1); windowEnd < end; ++windowEnd)
+            windowSum += detectionFunction[windowEnd];
 
-        for (int j = std::max(0, i - windowSize / 2); j < std::min(static_cast<int>(detectionFunction.size()), i + windowSize / 2 + 1); ++j)
-        {
-            sum += detectionFunction[j];
-            count++;
-        }
+        for (const int start = std::max(0, i - windowSize / 2); windowStart < start; ++windowStart)
+            windowSum -= detectionFunction[windowStart];
 
-        movingAverage[i] = sum / count;
+        movingAverage[i] = static_cast<float>(windowSum / (windowEnd - windowStart));
     }
 
     // Peak detection with adaptive threshold
-    for (int i = 1; i < detectionFunction.size() - 1; ++i)
+    for (int i = 1; i < size - 1; ++i)
     {
         // Calculate adaptive threshold
         float adaptiveThreshold = movingAverage[i] * threshold + (detectionSensitivity * 0.1f);
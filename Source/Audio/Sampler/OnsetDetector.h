@@ -20,6 +20,12 @@ public:
 
     ~OnsetDetector() = default;
 
+    // Analysis frame size and hop, in samples
+    static constexpr int frameSize = 2048;
+    static constexpr int hopSize = 512;
+    static constexpr float defaultThreshold = 0.3f;
+    static constexpr float defaultSensitivity = 0.7f;
+
     /**
      * Detect onsets in the given audio buffer
      * @param audioBuffer The audio buffer to analyze
@@ -28,6 +34,29 @@ public:
      */
     std::vector<float> detectOnsets(const juce::AudioBuffer<float> &audioBuffer, double sampleRate);
 
+    // Detection frames that fit into numSamples samples
+    static int getNumDetectionFrames(int numSamples);
+
+    /**
+     * Rectified spectral flux of detection frames [firstFrame, firstFrame + numFrames).
+     * The frame before firstFrame is analysed as well, so chunks computed separately, even
+     * on different threads, join up to exactly the serial result.
+     * @param flux Receives numFrames values
+     */
+    void computeSpectralFlux(const float *samples, int numSamples, int firstFrame, int numFrames, float *flux);
+
+    /**
+     * Normalises a complete detection function in place and picks its onsets
+     * @return Onset positions as normalized values (0.0-1.0)
+     */
+    std::vector<float> findOnsets(std::vector<float> &detectionFunction, int numSamples);
+
+    /**
+     * Magnitudes of complex bins as the real-only FFT leaves them, real and imaginary parts
+     * interleaved. Four bins at a time with SSE, or NEON on AArch64
+     */
+    static void computeMagnitudes(const float* interleavedBins, float* magnitudes, int numBins);
+
     /**
      * Set the threshold for onset detection
      * @param threshold Value between 0.0 and 1.0
@@ -41,16 +70,33 @@ public:
     void setSensitivity(float sensitivity) { detectionSensitivity = sensitivity; }
 
 private:
-    float detectionThreshold = 0.3f;
+    static constexpr int fftOrder = 11;
+    static constexpr int numBins = frameSize / 2 + 1;
+
+    float detectionThreshold = defaultThreshold;
 
-    float detectionSensitivity = 0.7f;
+    float detectionSensitivity = defaultSensitivity;
 
-    std::vector<float>
-    generateDetectionFunction(const juce::AudioBuffer<float> &audioBuffer, int hopSize, int frameSize);
+    juce::dsp::FFT fft;
+    juce::dsp::WindowingFunction<float> window;
+
+    // Workspaces sized once in the constructor, analysis never allocates per frame
+    std::vector<float> fftBuffer;
+    std::vector<float> fluxDifference;
+    std::vector<float> magnitudeSpectrum, prevMagnitudeSpectrum;
+    std::vector<float> movingAverage;
+
+    // Windows frame i of samples and replaces magnitudeSpectrum with its magnitudes
+    void computeMagnitudeSpectrum(const float *samples, int numSamples, int frame);
+
+    // Sum of the increases from prevMagnitudeSpectrum to magnitudeSpectrum
+    float computeRectifiedFlux();
 
     std::vector<int> findPeaks(const std::vector<float> &detectionFunction, float threshold);
 
     void normalizeBuffer(std::vector<float> &buffer);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OnsetDetector)
 };
 
 #endif //JAMMER_ONSETDETECTOR_H
@@ -0,0 +1,201 @@
+#include "SampleAnalyser.h"
+#include "OnsetDetector.h"
+#include "TempoEstimator.h"
+#include "SamplePool.h"
+
+struct SampleAnalyser::ChunkWorkspace {
+    // The chunk's frames and the one before them
+    static constexpr int maxSamples = framesPerChunk * OnsetDetector::hopSize + OnsetDetector::frameSize;
+
+    OnsetDetector detector;
+    std::vector<float> samples = std::vector<float>(static_cast<size_t>(maxSamples));
+};
+
+SampleAnalyser::SampleAnalyser() = default;
+
+SampleAnalyser::~SampleAnalyser() {
+    cancelPendingUpdate();
+    pool->removeJobs(this, true, 30000);
+}
+
+void SampleAnalyser::analyse(const std::vector<SamplerSound::Ptr> &sounds) {
+    for (const auto &sound: sounds) {
+        auto job = std::make_shared<Job>();
+        job->sound = sound;
+        ++numPending;
+
+        pool->addJob(this, [this, job] {
+            auto &analysedSound = *job->sound;
+            job->contentHash = SamplePool::hashFileContents(analysedSound.getSourceFile());
+
+            if ((job->result = cache->load(job->contentHash)) != nullptr) {
+                deliver(job);
+                return;
+            }
+
+            // The job holds the sound, so the reader stays valid for the chunks queued below
+            auto &source = job->source;
+            source.contentHash = job->contentHash;
+            source.numChannels = analysedSound.getNumStreamChannels();
+            source.numFrames = analysedSound.getLengthInSamples();
+            source.sampleRate = analysedSound.getSourceSampleRate();
+            source.read = [&analysedSound](juce::int64 startFrame, int numFrames,
+                                           float *const *destination, int numChannels) {
+                analysedSound.readAnalysisFrames(startFrame, numFrames, destination, numChannels);
+            };
+
+            readSource(*job);
+            startChunks(job);
+        });
+    }
+}
+
+SampleAnalysis::Ptr SampleAnalyser::analyseNow(const Source &source) {
+    if (auto cached = cache->load(source.contentHash)) {
+        return cached;
+    }
+
+    // Waiting here keeps whatever source.read refers to alive until the chunks are done
+    auto job = std::make_shared<Job>();
+    job->contentHash = source.contentHash;
+    job->source = source;
+
+    readSource(*job);
+    startChunks(job);
+    job->finished.wait();
+    job->source = {};
+
+    return job->result;
+}
+
+void SampleAnalyser::readSource(Job &job) {
+    const auto &source = job.source;
+    const int numChannels = juce::jmin(2, source.numChannels);
+    const auto numFrames = juce::jlimit<juce::int64>(0, std::numeric_limits<int>::max(), source.numFrames);
+
+    job.result = new SampleAnalysis();
+    job.numSamples = numChannels > 0 ? static_cast<int>(numFrames) : 0;
+    job.result->peaks.reset(numChannels);
+
+    if (numChannels > 0) {
+        juce::AudioBuffer<float> block(numChannels, static_cast<int>(juce::jmin<juce::int64>(readBlockSize, numFrames)));
+
+        for (juce::int64 start = 0; start < numFrames; start += readBlockSize) {
+            const int count = static_cast<int>(juce::jmin<juce::int64>(readBlockSize, numFrames - start));
+            source.read(start, count, block.getArrayOfWritePointers(), numChannels);
+            job.result->peaks.addFrames(block.getArrayOfReadPointers(), count);
+        }
+    }
+
+    job.result->peaks.finish();
+    job.result->loudness = LoudnessStats::measure(job.result->peaks, source.sampleRate);
+}
+
+void SampleAnalyser::startChunks(const std::shared_ptr<Job> &job) {
+    const int numFrames = OnsetDetector::getNumDetectionFrames(job->numSamples);
+    const int numChunks = (numFrames + framesPerChunk - 1) / framesPerChunk;
+
+    if (numChunks == 0) {
+        finishJob(job);
+        return;
+    }
+
+    job->detectionFunction.assign(static_cast<size_t>(numFrames), 0.0f);
+    job->chunksRemaining.store(numChunks);
+
+    for (int chunk = 0; chunk < numChunks; ++chunk) {
+        pool->addJob(this, [this, job, chunk, numFrames] {
+            const int firstFrame = chunk * framesPerChunk;
+            computeChunk(*job, firstFrame, juce::jmin(framesPerChunk, numFrames - firstFrame));
+
+            if (job->chunksRemaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                finishJob(job);
+            }
+        });
+    }
+}
+
+void SampleAnalyser::computeChunk(Job &job, int firstFrame, int numFrames) {
+    // The frame before the chunk is analysed too, its samples overlap the chunk's first frame
+    const int readFrame = juce::jmax(0, firstFrame - 1);
+    const int firstSample = readFrame * OnsetDetector::hopSize;
+    const int numChunkSamples = juce::jmin(job.numSamples - firstSample,
+                                           (firstFrame + numFrames - 1 - readFrame) * OnsetDetector::hopSize
+                                           + OnsetDetector::frameSize);
+
+    auto workspace = acquireWorkspace();
+    jassert(numChunkSamples <= ChunkWorkspace::maxSamples);
+
+    for (int offset = 0; offset < numChunkSamples; offset += readBlockSize) {
+        float *destination = workspace->samples.data() + offset;
+        job.source.read(firstSample + offset, juce::jmin(readBlockSize, numChunkSamples - offset), &destination, 1);
+    }
+
+    // Frames count from readFrame inside the chunk's samples
+    workspace->detector.computeSpectralFlux(workspace->samples.data(), numChunkSamples, firstFrame - readFrame,
+                                            numFrames, job.detectionFunction.data() + firstFrame);
+
+    releaseWorkspace(std::move(workspace));
+}
+
+std::unique_ptr<SampleAnalyser::ChunkWorkspace> SampleAnalyser::acquireWorkspace() {
+    {
+        const std::lock_guard<std::mutex> lock(workspaceLock);
+        if (!freeWorkspaces.empty()) {
+            auto workspace = std::move(freeWorkspaces.back());
+            freeWorkspaces.pop_back();
+            return workspace;
+        }
+    }
+
+    // Only while more chunks run at once than ever before
+    return std::make_unique<ChunkWorkspace>();
+}
+
+void SampleAnalyser::releaseWorkspace(std::unique_ptr<ChunkWorkspace> workspace) {
+    const std::lock_guard<std::mutex> lock(workspaceLock);
+    freeWorkspaces.push_back(std::move(workspace));
+}
+
+void SampleAnalyser::finishJob(const std::shared_ptr<Job> &job) {
+    // The tempo reads the same detection function, before picking the onsets normalises it
+    job->result->beatGrid = TempoEstimator::estimate(job->detectionFunction, OnsetDetector::frameSize,
+                                                     OnsetDetector::hopSize,
+                                                     job->source.sampleRate,
+                                                     static_cast<juce::int64>(job->numSamples));
+
+    OnsetDetector detector;
+    job->result->onsetMarkers = detector.findOnsets(job->detectionFunction, job->numSamples);
+    job->detectionFunction = {};
+
+    cache->store(job->contentHash, *job->result);
+
+    if (job->sound == nullptr) {
+        job->finished.signal();
+        return;
+    }
+
+    deliver(job);
+}
+
+void SampleAnalyser::deliver(const std::shared_ptr<Job> &job) {
+    {
+        const std::lock_guard<std::mutex> lock(resultsLock);
+        results.push_back(job);
+    }
+
+    triggerAsyncUpdate();
+}
+
+void SampleAnalyser::handleAsyncUpdate() {
+    std::vector<std::shared_ptr<Job>> finished;
+    {
+        const std::lock_guard<std::mutex> lock(resultsLock);
+        finished.swap(results);
+    }
+
+    for (const auto &job: finished) {
+        job->sound->setAnalysis(job->result);
+        --numPending;
+    }
+}
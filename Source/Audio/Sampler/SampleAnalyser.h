@@ -0,0 +1,107 @@
+#pragma once
+
+#include <juce_audio_utils/juce_audio_utils.h>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "AnalysisCache.h"
+#include "SampleAnalysis.h"
+#include "SamplerSound.h"
+#include "../Util/SharedWorkerPool.h"
+
+// Analysis workers shared by every instance, chunks keep all but one core busy
+struct AnalysisWorkerPool : public SharedWorkerPool {
+    AnalysisWorkerPool() : SharedWorkerPool(juce::jmax(1, juce::SystemStats::getNumCpus() - 1)) {}
+};
+
+/**
+ * Analyses many samples at once on the process-wide analysis workers: onsets, the peak pyramid and
+ * loudness. Each sample's onset detection frames are split into chunks that run as separate
+ * jobs, so a single long file spreads over every worker too, and the chunk that finishes
+ * last picks the onsets. Every job reads the source block by block, so no sample is ever
+ * held whole and a streamed one's reader is only locked for one block at a time.
+ * Finished analyses go to the AnalysisCache, samples found there are not analysed again.
+ */
+class SampleAnalyser : private juce::AsyncUpdater {
+public:
+    using FrameReader = std::function<void(juce::int64 startFrame, int numFrames,
+                                           float *const *destination, int numChannels)>;
+
+    // What an analysis reads, channels past the first two are left out
+    struct Source {
+        juce::String contentHash; // Key into the AnalysisCache, empty skips the cache
+        int numChannels = 0;
+        juce::int64 numFrames = 0;
+        double sampleRate = 0.0;
+        FrameReader read;
+    };
+
+    // Detection frames per job, around three seconds of audio at 44.1 kHz
+    static constexpr int framesPerChunk = 256;
+
+    // Frames read from the source at a time
+    static constexpr int readBlockSize = 65536;
+
+    SampleAnalyser();
+
+    ~SampleAnalyser() override;
+
+    // Message thread: analyses each sound in the background, or loads its analysis from the
+    // cache, and hands it to setAnalysis back on the message thread
+    void analyse(const std::vector<SamplerSound::Ptr> &sounds);
+
+    // Analyses source on the workers and waits for the result. Any thread except the workers
+    SampleAnalysis::Ptr analyseNow(const Source &source);
+
+    // Sounds queued or being analysed. Message thread only
+    [[nodiscard]] int getNumPending() const { return numPending; }
+
+private:
+    struct Job {
+        SamplerSound::Ptr sound; // nullptr for analyseNow
+        juce::String contentHash;
+        Source source; // Readable until the job has finished
+        int numSamples = 0;
+        SampleAnalysis::Ptr result;
+        std::vector<float> detectionFunction;
+        std::atomic<int> chunksRemaining{0};
+        juce::WaitableEvent finished;
+    };
+
+    juce::SharedResourcePointer<AnalysisCache> cache;
+    juce::SharedResourcePointer<AnalysisWorkerPool> pool;
+
+    // Detector and sample buffer for one chunk, handed from chunk to chunk so they are not rebuilt
+    struct ChunkWorkspace;
+    std::mutex workspaceLock;
+    std::vector<std::unique_ptr<ChunkWorkspace>> freeWorkspaces; // At most one per worker ever gets made
+
+    std::mutex resultsLock;
+    std::vector<std::shared_ptr<Job>> results;
+    int numPending = 0;
+
+    // Reads the source through once for the pyramid and loudness
+    static void readSource(Job &job);
+
+    // Spectral flux of one chunk of detection frames, reading only the first channel's frames it covers
+    void computeChunk(Job &job, int firstFrame, int numFrames);
+
+    std::unique_ptr<ChunkWorkspace> acquireWorkspace();
+
+    void releaseWorkspace(std::unique_ptr<ChunkWorkspace> workspace);
+
+    // Queues a job per chunk, or finishes straight away when the sample is too short for one
+    void startChunks(const std::shared_ptr<Job> &job);
+
+    void finishJob(const std::shared_ptr<Job> &job);
+
+    // Hands a finished analysis of a sound to the message thread
+    void deliver(const std::shared_ptr<Job> &job);
+
+    void handleAsyncUpdate() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleAnalyser)
+};
@@ -0,0 +1,178 @@
+#include "SampleAnalysis.h"
+
+void PeakPyramid::reset(int newNumChannels) {
+    numChannels = newNumChannels;
+    numFrames = 0;
+    levels.assign(1, std::vector<std::vector<Peak>>(static_cast<size_t>(numChannels)));
+    pendingPeaks.assign(static_cast<size_t>(numChannels), {});
+    pendingFrames = 0;
+}
+
+void PeakPyramid::addFrames(const float *const *channels, int numFramesToAdd) {
+    int offset = 0;
+    while (offset < numFramesToAdd) {
+        const int count = juce::jmin(baseFramesPerPeak - pendingFrames, numFramesToAdd - offset);
+
+        for (int channel = 0; channel < numChannels; ++channel) {
+            const float *samples = channels[channel] + offset;
+            auto &peak = pendingPeaks[static_cast<size_t>(channel)];
+
+            const auto range = juce::FloatVectorOperations::findMinAndMax(samples, count);
+            float squares = 0.0f;
+            for (int i = 0; i < count; ++i) {
+                squares += samples[i] * samples[i];
+            }
+
+            if (pendingFrames == 0) {
+                peak = {range.getStart(), range.getEnd(), squares};
+            } else {
+                peak.min = juce::jmin(peak.min, range.getStart());
+                peak.max = juce::jmax(peak.max, range.getEnd());
+                peak.rms += squares;
+            }
+        }
+
+        pendingFrames += count;
+        offset += count;
+        numFrames += count;
+
+        if (pendingFrames == baseFramesPerPeak) {
+            closePendingPeaks();
+        }
+    }
+}
+
+void PeakPyramid::closePendingPeaks() {
+    for (int channel = 0; channel < numChannels; ++channel) {
+        auto peak = pendingPeaks[static_cast<size_t>(channel)];
+        peak.rms = std::sqrt(peak.rms / static_cast<float>(pendingFrames));
+        levels[0][static_cast<size_t>(channel)].push_back(peak);
+    }
+    pendingFrames = 0;
+}
+
+void PeakPyramid::finish() {
+    if (pendingFrames > 0) {
+        closePendingPeaks();
+    }
+
+    // Halve until one peak covers everything. A trailing odd peak is carried up on its own,
+    // its RMS is only approximate since it may cover fewer frames than its neighbours
+    while (numChannels > 0 && levels.back()[0].size() > 1) {
+        const auto &below = levels.back();
+        std::vector<std::vector<Peak>> level(static_cast<size_t>(numChannels));
+
+        for (int channel = 0; channel < numChannels; ++channel) {
+            const auto &source = below[static_cast<size_t>(channel)];
+            auto &merged = level[static_cast<size_t>(channel)];
+            merged.reserve((source.size() + 1) / 2);
+
+            for (size_t i = 0; i < source.size(); i += 2) {
+                if (i + 1 == source.size()) {
+                    merged.push_back(source[i]);
+                    continue;
+                }
+                const auto &a = source[i];
+                const auto &b = source[i + 1];
+                merged.push_back({juce::jmin(a.min, b.min), juce::jmax(a.max, b.max),
+                                  std::sqrt((a.rms * a.rms + b.rms * b.rms) * 0.5f)});
+            }
+        }
+
+        levels.push_back(std::move(level));
+    }
+
+    pendingPeaks.clear();
+}
+
+int PeakPyramid::getLevelForResolution(double framesPerPixel) const {
+    int level = 0;
+    while (level + 1 < getNumLevels() && static_cast<double>(getFramesPerPeak(level + 1)) <= framesPerPixel) {
+        ++level;
+    }
+    return level;
+}
+
+const std::vector<PeakPyramid::Peak> &PeakPyramid::getPeaks(int level, int channel) const {
+    return levels[static_cast<size_t>(level)][static_cast<size_t>(channel)];
+}
+
+void PeakPyramid::writeTo(juce::OutputStream &output) const {
+    output.writeInt(numChannels);
+    output.writeInt64(numFrames);
+    output.writeInt(getNumLevels());
+
+    for (const auto &level: levels) {
+        for (const auto &peaks: level) {
+            output.writeInt(static_cast<int>(peaks.size()));
+            output.write(peaks.data(), peaks.size() * sizeof(Peak));
+        }
+    }
+}
+
+bool PeakPyramid::readFrom(juce::InputStream &input) {
+    numChannels = input.readInt();
+    numFrames = input.readInt64();
+    const int numLevels = input.readInt();
+
+    if (numChannels <= 0 || numChannels > 2 || numFrames <= 0 || numLevels <= 0 || numLevels > 64) {
+        return false;
+    }
+
+    levels.assign(static_cast<size_t>(numLevels), std::vector<std::vector<Peak>>(static_cast<size_t>(numChannels)));
+
+    for (int level = 0; level < numLevels; ++level) {
+        // Each level must have exactly as many peaks as the sample length implies
+        const juce::int64 expected = juce::jmax<juce::int64>(1, (numFrames + getFramesPerPeak(level) - 1) / getFramesPerPeak(level));
+
+        for (auto &peaks: levels[static_cast<size_t>(level)]) {
+            if (input.readInt() != expected) {
+                return false;
+            }
+            peaks.resize(static_cast<size_t>(expected));
+            const auto numBytes = static_cast<int>(peaks.size() * sizeof(Peak));
+            if (input.read(peaks.data(), numBytes) != numBytes) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+LoudnessStats LoudnessStats::measure(const PeakPyramid &peaks, double sampleRate) {
+    LoudnessStats stats;
+    if (peaks.getNumLevels() == 0) {
+        return stats;
+    }
+
+    const int numChannels = peaks.getNumChannels();
+    const auto numPeaks = peaks.getPeaks(0, 0).size();
+    const int windowPeaks = juce::jmax(1, juce::roundToInt(shortTermSeconds * sampleRate / PeakPyramid::baseFramesPerPeak));
+
+    // Squares of each base peak summed over the channels, then a running sum over the window
+    std::vector<double> squares(numPeaks, 0.0);
+    for (int channel = 0; channel < numChannels; ++channel) {
+        const auto &channelPeaks = peaks.getPeaks(0, channel);
+        for (size_t i = 0; i < numPeaks; ++i) {
+            const auto &peak = channelPeaks[i];
+            stats.peak = juce::jmax(stats.peak, -peak.min, peak.max);
+            squares[i] += static_cast<double>(peak.rms) * peak.rms;
+        }
+    }
+
+    double total = 0.0, windowSum = 0.0, loudestWindow = 0.0;
+    for (size_t i = 0; i < numPeaks; ++i) {
+        total += squares[i];
+        windowSum += squares[i];
+        if (i >= static_cast<size_t>(windowPeaks)) {
+            windowSum -= squares[i - static_cast<size_t>(windowPeaks)];
+        }
+        loudestWindow = juce::jmax(loudestWindow, windowSum);
+    }
+
+    const auto numWindowPeaks = static_cast<double>(juce::jmin(numPeaks, static_cast<size_t>(windowPeaks)));
+    stats.rms = static_cast<float>(std::sqrt(total / (static_cast<double>(numPeaks) * numChannels)));
+    stats.maxShortTermRms = static_cast<float>(std::sqrt(loudestWindow / (numWindowPeaks * numChannels)));
+    return stats;
+}
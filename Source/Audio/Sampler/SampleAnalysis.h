@@ -0,0 +1,95 @@
+#pragma once
+
+#include <juce_audio_utils/juce_audio_utils.h>
+#include <vector>
+
+/**
+ * Min/max/RMS overview of a sample at halving resolutions. The finest level summarises
+ * baseFramesPerPeak frames per peak, each level above it merges pairs of the one below,
+ * up to a single peak for the whole sample.
+ */
+class PeakPyramid {
+public:
+    struct Peak {
+        float min = 0.0f;
+        float max = 0.0f;
+        float rms = 0.0f;
+    };
+
+    static constexpr int baseFramesPerPeak = 256;
+
+    // Starts an empty pyramid for numChannels channels
+    void reset(int numChannels);
+
+    // Adds the next numFrames frames, in order from the start of the sample
+    void addFrames(const float *const *channels, int numFrames);
+
+    // Closes the last partial peak and builds the coarser levels
+    void finish();
+
+    [[nodiscard]] int getNumChannels() const { return numChannels; }
+
+    [[nodiscard]] int getNumLevels() const { return static_cast<int>(levels.size()); }
+
+    [[nodiscard]] juce::int64 getNumFrames() const { return numFrames; }
+
+    [[nodiscard]] static juce::int64 getFramesPerPeak(int level) { return static_cast<juce::int64>(baseFramesPerPeak) << level; }
+
+    // Coarsest level whose peaks span no more than framesPerPixel frames, 0 when zoomed in further
+    [[nodiscard]] int getLevelForResolution(double framesPerPixel) const;
+
+    [[nodiscard]] const std::vector<Peak> &getPeaks(int level, int channel) const;
+
+    void writeTo(juce::OutputStream &output) const;
+
+    // False if the stream does not hold a complete pyramid
+    bool readFrom(juce::InputStream &input);
+
+private:
+    int numChannels = 0;
+    juce::int64 numFrames = 0;
+    std::vector<std::vector<std::vector<Peak>>> levels; // [level][channel][peak]
+
+    // The base peak being filled, its RMS fields hold the sum of squares until it is closed
+    std::vector<Peak> pendingPeaks;
+    int pendingFrames = 0;
+
+    void closePendingPeaks();
+};
+
+struct LoudnessStats {
+    float peak = 0.0f;            // Absolute peak over all channels
+    float rms = 0.0f;             // Over the whole sample and all channels
+    float maxShortTermRms = 0.0f; // Loudest stretch of shortTermSeconds
+
+    static constexpr double shortTermSeconds = 0.4;
+
+    // Derived from the base level of a finished pyramid
+    static LoudnessStats measure(const PeakPyramid &peaks, double sampleRate);
+};
+
+// Tempo and beat positions of a loop, in the sample's own frames
+struct BeatGrid {
+    static constexpr int beatsPerBar = 4;
+
+    double bpm = 0.0;            // 0 when no steady tempo was found
+    double firstBeatFrame = 0.0; // Source frame of the first beat
+    float confidence = 0.0f;     // 0-1, how periodic the onsets are at that tempo
+
+    [[nodiscard]] bool isValid() const { return bpm > 0.0; }
+};
+
+/**
+ * Everything derived from a sample's contents: onset markers, tempo, the peak pyramid and loudness.
+ * Built once on a worker thread and not modified after it is shared, between every sound
+ * playing the sample and through the AnalysisCache between sessions.
+ */
+class SampleAnalysis : public juce::ReferenceCountedObject {
+public:
+    using Ptr = juce::ReferenceCountedObjectPtr<SampleAnalysis>;
+
+    std::vector<float> onsetMarkers; // Normalised positions (0.0-1.0)
+    BeatGrid beatGrid;
+    PeakPyramid peaks;
+    LoudnessStats loudness;
+};
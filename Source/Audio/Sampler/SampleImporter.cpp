@@ -0,0 +1,192 @@
+#include "SampleImporter.h"
+#include "SampleAnalyser.h"
+
+SampleImporter::SampleImporter()
+        : analyser(std::make_unique<SampleAnalyser>()) {}
+
+SampleImporter::~SampleImporter() {
+    cancelPendingUpdate();
+    pool->removeJobs(this, true, 30000);
+}
+
+void SampleImporter::importFiles(const juce::Array<juce::File> &files, const Options &options) {
+    for (const auto &file: files) {
+        auto import = std::make_shared<PendingImport>();
+        import->file = file;
+        pending.push_back(import);
+
+        pool->addJob(this, [this, import, options] {
+            import->sound = loadSound(import->file, options, [&import](float progress) {
+                import->progress.store(progress, std::memory_order_relaxed);
+            });
+            import->finished.store(true, std::memory_order_release);
+            triggerAsyncUpdate();
+        });
+    }
+}
+
+void SampleImporter::resampleSounds(const std::vector<SamplerSound::Ptr> &sounds, double targetRate) {
+    for (const auto &sound: sounds) {
+        pool->addJob(this, [sound, targetRate] {
+            sound->buildResampledAudio(targetRate);
+        });
+    }
+}
+
+void SampleImporter::primeStreamHeads(const std::vector<SamplerSound::Ptr> &sounds) {
+    for (const auto &sound: sounds) {
+        pool->addJob(this, [sound] {
+            sound->primeStreamHead();
+        });
+    }
+}
+
+void SampleImporter::analyseSounds(const std::vector<SamplerSound::Ptr> &sounds) {
+    analyser->analyse(sounds);
+}
+
+void SampleImporter::cancelAll() {
+    // Running jobs finish on their own, they only hold their shared PendingImport
+    pool->removeJobs(this, false, 0);
+    pending.clear();
+}
+
+juce::String SampleImporter::getPendingName(int index) const {
+    if (index >= 0 && index < getNumPending()) {
+        return pending[static_cast<size_t>(index)]->file.getFileNameWithoutExtension();
+    }
+    return {};
+}
+
+float SampleImporter::getPendingProgress(int index) const {
+    if (index >= 0 && index < getNumPending()) {
+        return pending[static_cast<size_t>(index)]->progress.load(std::memory_order_relaxed);
+    }
+    return 0.0f;
+}
+
+void SampleImporter::handleAsyncUpdate() {
+    // Commit in queue order, a finished file waits for the ones dropped before it
+    while (!pending.empty() && pending.front()->finished.load(std::memory_order_acquire)) {
+        auto import = pending.front();
+        pending.erase(pending.begin());
+
+        if (import->sound != nullptr && onSampleImported) {
+            onSampleImported(import->file, std::move(import->sound));
+        }
+    }
+}
+
+std::unique_ptr<SamplerSound> SampleImporter::loadSound(const juce::File &file,
+                                                        const Options &options,
+                                                        const std::function<void(float)> &onProgress) {
+    auto reportProgress = [&onProgress](float progress) {
+        if (onProgress) {
+            onProgress(progress);
+        }
+    };
+
+    // A manager per load, so concurrent imports share no format state
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+    if (reader == nullptr) {
+        return nullptr;
+    }
+
+    reportProgress(0.1f);
+
+    juce::BigInteger allNotes;
+    allNotes.setRange(0, 128, true);
+
+    const juce::String name = file.getFileNameWithoutExtension();
+    const double sampleRate = reader->sampleRate;
+    const bool stream = options.streamLongSamples
+                        && static_cast<double>(reader->lengthInSamples) > options.streamingThresholdSeconds * sampleRate;
+
+    std::unique_ptr<SamplerSound> samplerSound;
+
+    // Uncompressed WAV/AIFF can be played straight from the page cache in place of a float
+    // copy. Long files still stream and compact storage still decodes, so mapping never
+    // replaces either. Mapped sounds get no host-rate copy, their voices convert as they play
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> mappedReader;
+    if (options.memoryMap && !stream && !options.compactStorage) {
+        if (auto *format = formatManager.findFormatForFileExtension(file.getFileExtension())) {
+            mappedReader.reset(format->createMemoryMappedReader(file));
+            if (mappedReader != nullptr && !mappedReader->mapEntireFile()) {
+                mappedReader.reset();
+            }
+        }
+    }
+
+    // Mapped and streamed sounds are usable straight away, their analysis follows from analyseSounds
+    if (mappedReader != nullptr) {
+        samplerSound = std::make_unique<SamplerSound>(name, std::move(mappedReader), allNotes);
+        reportProgress(0.7f);
+
+        if (options.warmMappedPages) {
+            samplerSound->warmMappedPages();
+        }
+    } else if (stream) {
+        samplerSound = std::make_unique<SamplerSound>(name, std::move(reader), file, allNotes);
+    } else {
+        // Whole samples are decoded once per process, the hash is far cheaper than decoding again
+        const auto format = CompactSampleData::chooseFormat(*reader);
+        const juce::String contentHash = SamplePool::hashFileContents(file);
+        reportProgress(0.2f);
+
+        SharedSampleData::Ptr data;
+
+        if (options.compactStorage) {
+            const juce::String key = contentHash + (format == CompactSampleData::Format::Int16 ? ":int16" : ":half");
+            data = samplePool->getOrLoad(key, [this, &reader, format, &contentHash, &reportProgress] {
+                auto decoded = SharedSampleData::decodeCompact(*reader, format);
+                if (decoded != nullptr) {
+                    reportProgress(0.5f);
+                    decoded->setAnalysis(analyseDecoded(*decoded, contentHash));
+                }
+                return decoded;
+            });
+        }
+
+        // Float storage, also the fallback if the file could not be read through as 16-bit words
+        if (data == nullptr) {
+            data = samplePool->getOrLoad(contentHash + ":float", [this, &reader, &contentHash, &reportProgress] {
+                auto decoded = SharedSampleData::decodeFloat(*reader);
+                if (decoded != nullptr) {
+                    reportProgress(0.6f);
+                    decoded->setAnalysis(analyseDecoded(*decoded, contentHash));
+                }
+                return decoded;
+            });
+        }
+
+        if (data == nullptr) {
+            return nullptr;
+        }
+
+        samplerSound = std::make_unique<SamplerSound>(name, data, file, allNotes);
+
+        if (options.resampleToRate > 0.0) {
+            reportProgress(0.8f);
+            samplerSound->buildResampledAudio(options.resampleToRate);
+        }
+    }
+
+    reportProgress(1.0f);
+    return samplerSound;
+}
+
+SampleAnalysis::Ptr SampleImporter::analyseDecoded(const SharedSampleData &data, const juce::String &contentHash) {
+    SampleAnalyser::Source source;
+    source.contentHash = contentHash;
+    source.numChannels = data.getNumChannels();
+    source.numFrames = data.getNumFrames();
+    source.sampleRate = data.getSampleRate();
+    source.read = [&data](juce::int64 startFrame, int numFrames, float *const *destination, int numChannels) {
+        data.readFrames(startFrame, numFrames, destination, numChannels);
+    };
+
+    return analyser->analyseNow(source);
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <juce_audio_utils/juce_audio_utils.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "SamplerSound.h"
+#include "../Util/SharedWorkerPool.h"
+
+class SampleAnalyser;
+
+// Decoding workers shared by every instance, imports are mostly disk bound so a few are enough
+struct ImportWorkerPool : public SharedWorkerPool {
+    ImportWorkerPool() : SharedWorkerPool(juce::jlimit(1, 4, juce::SystemStats::getNumCpus() - 1)) {}
+};
+
+/**
+ * Decodes and analyses sample files on the process-wide import workers.
+ * Finished sounds are handed back on the message thread in the order the files were
+ * queued, so the sample list keeps the order of a multi-file drop.
+ */
+class SampleImporter : private juce::AsyncUpdater {
+public:
+    struct Options {
+        bool memoryMap = false; // Only for float storage below the streaming threshold
+        bool warmMappedPages = true;
+        bool streamLongSamples = true;
+        double streamingThresholdSeconds = 30.0;
+        bool compactStorage = false;
+        double resampleToRate = 0.0; // Host rate for in-memory sounds to be converted to, 0 keeps their own
+    };
+
+    SampleImporter();
+
+    ~SampleImporter() override;
+
+    // Called on the message thread for every file that decoded successfully
+    std::function<void(const juce::File &, std::unique_ptr<SamplerSound>)> onSampleImported;
+
+    void importFiles(const juce::Array<juce::File> &files, const Options &options);
+
+    // Rebuilds each sound's copy at targetRate on the worker threads
+    void resampleSounds(const std::vector<SamplerSound::Ptr> &sounds, double targetRate);
+
+    // Reads each streaming sound's head from its current start marker on the worker threads
+    void primeStreamHeads(const std::vector<SamplerSound::Ptr> &sounds);
+
+    // Analyses mapped and streamed sounds in the background, or loads them from the analysis
+    // cache. Each sound gets its analysis on the message thread once it is done
+    void analyseSounds(const std::vector<SamplerSound::Ptr> &sounds);
+
+    // Forgets every queued and running import, their results are discarded
+    void cancelAll();
+
+    // Imports still in flight, in queue order. Message thread only
+    [[nodiscard]] int getNumPending() const { return static_cast<int>(pending.size()); }
+
+    [[nodiscard]] juce::String getPendingName(int index) const;
+
+    [[nodiscard]] float getPendingProgress(int index) const;
+
+    // Decodes, maps or opens the file for streaming on the calling thread. Decoded samples are
+    // analysed here, split across the analysis workers. Decoded data comes from the process-wide pool when another instance already loaded the file
+    std::unique_ptr<SamplerSound> loadSound(const juce::File &file,
+                                            const Options &options,
+                                            const std::function<void(float)> &onProgress = nullptr);
+
+private:
+    struct PendingImport {
+        juce::File file;
+        std::atomic<float> progress{0.0f};
+        std::atomic<bool> finished{false};
+        std::unique_ptr<SamplerSound> sound; // Written by the worker before finished is set
+    };
+
+    juce::SharedResourcePointer<SamplePool> samplePool;
+
+    // The destructor waits for this importer's jobs, which use the analyser, before either goes
+    std::unique_ptr<SampleAnalyser> analyser;
+    juce::SharedResourcePointer<ImportWorkerPool> pool;
+    std::vector<std::shared_ptr<PendingImport>> pending;
+
+    void handleAsyncUpdate() override;
+
+    // Onsets, peaks and loudness of freshly decoded data, from the analysis cache when it has them
+    SampleAnalysis::Ptr analyseDecoded(const SharedSampleData &data, const juce::String &contentHash);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleImporter)
+};
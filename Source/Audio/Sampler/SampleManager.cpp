@@ -1,18 +1,38 @@
 #include "SampleManager.h"
 #include <algorithm>
-#include <random>
 #include <utility>
 
-SampleManager::SampleManager(PluginProcessor &p) : processor(p) {
+SampleManager::SampleManager(PluginProcessor &p)
+        : processor(p), random(p.getRandomService().getStream(RandomService::Stream::Samples)) {
     processor.getAPVTS().addParameterListener(Params::ID_SAMPLE_DIRECTION, this);
     processor.getAPVTS().addParameterListener(Params::ID_SAMPLE_PITCH_FOLLOW, this);
+    processor.getAPVTS().addParameterListener(Params::ID_SAMPLE_INTERPOLATION, this);
+    processor.getAPVTS().addParameterListener(Params::ID_SAMPLE_INTERPOLATION_OFFLINE, this);
+    processor.getAPVTS().addParameterListener(Params::ID_SAMPLE_VOICES, this);
+    processor.getAPVTS().addParameterListener(Params::ID_SAMPLE_STREAMING, this);
+    processor.getAPVTS().addParameterListener(Params::ID_SAMPLE_MEMORY_MAP, this);
+    processor.getAPVTS().addParameterListener(Params::ID_SAMPLE_WARM_PAGES, this);
+    processor.getAPVTS().addParameterListener(Params::ID_SAMPLE_RESAMPLE, this);
+    processor.getAPVTS().addParameterListener(Params::ID_SAMPLE_COMPACT, this);
+
+    processor.getAPVTS().addParameterListener(Params::ID_SAMPLE_SLICE_ORDER, this);
+    processor.getAPVTS().addParameterListener(Params::ID_SAMPLE_BEAT_SYNC, this);
 
-    formatManager.registerBasicFormats();
-    sampler.addVoice(new SamplerVoice(voiceState));
     sampler.setNoteStealingEnabled(true);
+    voiceState.setSliceRandomStream(&p.getRandomService().getStream(RandomService::Stream::Slices));
+
+    importer.onSampleImported = [this](const juce::File &file, std::unique_ptr<SamplerSound> sound) {
+        commitSample(file, std::move(sound));
+    };
 }
 
 SampleManager::~SampleManager() {
+    cancelPendingUpdate();
+
+    // Playback has stopped by now, end every note so the streamer lets go of its sounds
+    sampler.allNotesOff(0, false);
+    streamer.waitUntilRequestsServed();
+
     clearAllSamples();
 }
 
@@ -21,68 +41,217 @@ void SampleManager::parameterChanged(const juce::String &parameterID, float newV
         sampleDirection = static_cast<Models::DirectionType>(static_cast<int>(newValue));
     } else if (parameterID == Params::ID_SAMPLE_PITCH_FOLLOW) {
         voiceState.setPitchFollowEnabled(newValue > 0.5f);
+    } else if (parameterID == Params::ID_SAMPLE_INTERPOLATION) {
+        voiceState.setRealtimeInterpolationMode(Params::toEnum<Models::InterpolationMode>(newValue));
+    } else if (parameterID == Params::ID_SAMPLE_INTERPOLATION_OFFLINE) {
+        voiceState.setOfflineInterpolationMode(Params::toEnum<Models::InterpolationMode>(newValue));
+    } else if (parameterID == Params::ID_SAMPLE_VOICES) {
+        sampler.setVoiceLimit(Params::toInt(newValue));
+    } else if (parameterID == Params::ID_SAMPLE_STREAMING) {
+        streamLongSamples = newValue > 0.5f;
+    } else if (parameterID == Params::ID_SAMPLE_MEMORY_MAP) {
+        memoryMapSamples = newValue > 0.5f;
+    } else if (parameterID == Params::ID_SAMPLE_WARM_PAGES) {
+        warmMappedPages = newValue > 0.5f;
+    } else if (parameterID == Params::ID_SAMPLE_COMPACT) {
+        compactSamples = newValue > 0.5f;
+    } else if (parameterID == Params::ID_SAMPLE_SLICE_ORDER) {
+        voiceState.setRandomSliceOrder(Params::toInt(newValue) == 1);
+    } else if (parameterID == Params::ID_SAMPLE_BEAT_SYNC) {
+        voiceState.setBeatSyncEnabled(newValue > 0.5f);
+    } else if (parameterID == Params::ID_SAMPLE_RESAMPLE) {
+        resampleToHostRate = newValue > 0.5f;
+        voiceState.setResampledPlaybackEnabled(resampleToHostRate);
+        // May arrive on the audio thread, the copies are queued from the message thread
+        triggerAsyncUpdate();
+    }
+}
+
+void SampleManager::prepareToPlay(double sampleRate, int samplesPerBlock) {
+    // The whole pool is allocated here so note-ons never allocate, the voice limit
+    // parameter decides how many of these voices are actually used
+    if (sampler.getNumVoices() != SamplerSynthesiser::maxVoices) {
+        sampler.clearVoices();
+        for (int i = 0; i < SamplerSynthesiser::maxVoices; ++i) {
+            sampler.addVoice(new SamplerVoice(voiceState));
+        }
     }
-}
 
-void SampleManager::prepareToPlay(double sampleRate) {
     sampler.setCurrentPlaybackSampleRate(sampleRate);
+
+    if (hostSampleRate.exchange(sampleRate) != sampleRate) {
+        triggerAsyncUpdate();
+    }
+    streamer.prepare(sampler.getNumVoices(), 2);
+
+    for (int i = 0; i < sampler.getNumVoices(); ++i) {
+        if (auto *voice = dynamic_cast<SamplerVoice *>(sampler.getVoice(i))) {
+            voice->prepare(samplesPerBlock);
+            voice->setStream(streamer.getStream(i));
+        }
+    }
+
     sampler.allNotesOff(0, true);
 }
 
 void SampleManager::processAudio(juce::AudioBuffer<float> &buffer,
                                  juce::MidiBuffer &processedMidi) {
+    // Pin one sample set for the whole block, voices started below bind their sounds from it
+    auto sampleSet = voiceState.readSampleSet();
+
     int currentSampleIdx = processor.getNoteGenerator().getCurrentActiveSampleIdx();
-    if (currentSampleIdx < 0 || currentSampleIdx >= getNumSamples()) {
+    if (!sampleSet || currentSampleIdx < 0 || currentSampleIdx >= sampleSet->getNumSamples()) {
+        // Nothing to start, but playing notes still render and get their note-offs, e.g. the
+        // gate ending in this very block. Note-ons bind no sound without a valid index
+        if (sampler.hasActiveVoices()) {
+            voiceState.setCurrentSampleIndex(-1);
+            sampler.renderNextBlock(buffer, processedMidi, 0, buffer.getNumSamples());
+        }
         return;
     }
 
+    // Only notes starting from here on pick this up, playing voices keep the sound they bound
     voiceState.setCurrentSampleIndex(currentSampleIdx);
-    if (currentSampleIdx != voiceState.getCurrentSampleIndex()) {
-        sampler.allNotesOff(0, false);
-    }
+    voiceState.setRenderingOffline(processor.isNonRealtime());
+
+    const auto &timing = processor.getTimingManager();
+    voiceState.setHostTiming(timing.getBpm(), timing.getPpqPosition(),
+                             timing.getLastBarStartPpq(), timing.getQuartersPerBar());
 
     sampler.renderNextBlock(
             buffer, processedMidi, 0, buffer.getNumSamples());
 }
 
 void SampleManager::addSample(const juce::File &file) {
-    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+    if (auto sound = importer.loadSound(file, getImportOptions())) {
+        commitSample(file, std::move(sound));
+    }
+}
 
-    if (reader != nullptr) {
-        juce::BigInteger allNotes;
-        allNotes.setRange(0, 128, true);
+void SampleManager::importSamples(const juce::Array<juce::File> &files) {
+    importer.importFiles(files, getImportOptions());
+}
 
-        int sampleIndex = sampleList.size();
+SampleImporter::Options SampleManager::getImportOptions() const {
+    SampleImporter::Options options;
+    options.memoryMap = memoryMapSamples;
+    options.warmMappedPages = warmMappedPages;
+    options.streamLongSamples = streamLongSamples;
+    options.streamingThresholdSeconds = streamingThresholdSeconds;
+    options.compactStorage = compactSamples;
+    options.resampleToRate = resampleToHostRate ? hostSampleRate.load() : 0.0;
+    return options;
+}
 
-        auto newSample = std::make_unique<SampleInfo>(
-                file.getFileNameWithoutExtension(), file, sampleIndex);
+void SampleManager::commitSample(const juce::File &file, std::unique_ptr<SamplerSound> sound) {
+    int sampleIndex = sampleList.size();
 
-        auto samplerSound =
-                new SamplerSound(file.getFileNameWithoutExtension(), *reader, allNotes);
+    auto newSample = std::make_unique<SampleInfo>(
+            file.getFileNameWithoutExtension(), file, sampleIndex);
 
-        samplerSound->setIndex(sampleIndex);
+    sound->setIndex(sampleIndex);
+    newSample->sound = sound.release();
 
-        juce::AudioBuffer<float> *audioData = samplerSound->getAudioData();
-        double sampleRate = samplerSound->getSourceSampleRate();
+    // Mapped and streamed sounds skip analysis while loading so they play sooner
+    if (newSample->sound->getAnalysis() == nullptr) {
+        importer.analyseSounds({newSample->sound});
+    }
+
+    sampleList.push_back(std::move(newSample));
+
+    if (sampleList.size() == 1)
+        currentSelectedSample = 0;
+
+    publishSampleSet();
+}
+
+void SampleManager::publishSampleSet() {
+    auto sampleSet = std::make_unique<SampleSet>();
+    sampleSet->samples.reserve(sampleList.size());
+    sampleSet->soundTable.reserve(sampleList.size());
+
+    for (const auto &sample: sampleList) {
+        sampleSet->samples.push_back({sample->sound, sample->probability, sample->groupIndex});
+        sampleSet->soundTable.push_back(sample->sound.get());
+    }
+
+    for (const auto &group: groups) {
+        sampleSet->groupProbabilities.push_back(group->probability);
+    }
+
+    std::vector<float> sampleProbabilities;
+    std::vector<int> sampleGroups;
+    for (const auto &sample: sampleSet->samples) {
+        sampleProbabilities.push_back(sample.probability);
+        sampleGroups.push_back(sample.groupIndex);
+    }
 
-        if (audioData != nullptr && audioData->getNumSamples() > 0) {
-            std::vector<float> onsetPositions = onsetDetector.detectOnsets(*audioData, sampleRate);
-            samplerSound->setOnsetMarkers(onsetPositions);
+    for (int rate = 0; rate < Models::NUM_RATE_OPTIONS; ++rate) {
+        auto &validSamples = sampleSet->validSamplesForRate[static_cast<size_t>(rate)];
+        for (size_t i = 0; i < sampleList.size(); ++i) {
+            if (isSampleRateEnabled(static_cast<int>(i), static_cast<Models::RateOption>(rate))) {
+                validSamples.push_back(static_cast<int>(i));
+            }
         }
 
-        newSample->sound.reset(samplerSound);
+        sampleSet->selectorForRate[static_cast<size_t>(rate)].build(validSamples, sampleProbabilities, sampleGroups,
+                                                                    sampleSet->groupProbabilities);
+    }
+
+    numPublishedSamples.store(sampleSet->getNumSamples(), std::memory_order_relaxed);
+    voiceState.publishSampleSet(std::move(sampleSet));
+
+    releaseRetiredSounds();
+}
+
+void SampleManager::releaseRetiredSounds() {
+    voiceState.collectRetiredSampleSets();
 
-        sampler.addSound(samplerSound);
-        registerSoundWithIndex(samplerSound, sampleIndex);
-        sampleList.push_back(std::move(newSample));
+    // Once this list holds the only reference, no sample set is left that the audio thread
+    // could take the sound from, and no voice is playing it
+    auto unused = std::partition(retiredSounds.begin(), retiredSounds.end(), [](const SamplerSound::Ptr &sound) {
+        return sound->getReferenceCount() > 1;
+    });
 
-        if (sampleList.size() == 1)
-            currentSelectedSample = 0;
+    if (unused != retiredSounds.end()) {
+        // Voices stop their stream before dropping the sound, make sure the streamer has
+        // seen that before the sound goes away underneath it
+        streamer.waitUntilRequestsServed();
+        retiredSounds.erase(unused, retiredSounds.end());
 
-        for (int i = 0; i < Models::NUM_RATE_OPTIONS; ++i) {
-            updateValidSamplesForRate(static_cast<Models::RateOption>(i));
+        // Decoded data goes once no instance's sounds use it any more
+        samplePool->releaseUnused();
+    }
+
+    // Stream heads replaced while voices were still playing them
+    bool retiredDataLeft = false;
+    for (const auto &sample: sampleList) {
+        retiredDataLeft = sample->sound->collectRetiredData() || retiredDataLeft;
+    }
+
+    if (retiredSounds.empty() && !retiredDataLeft) {
+        stopTimer();
+    } else if (!isTimerRunning()) {
+        startTimer(retiredSoundPollMs);
+    }
+}
+
+void SampleManager::resampleSoundsToHostRate() {
+    const double sampleRate = hostSampleRate.load();
+    if (!resampleToHostRate || sampleRate <= 0.0) {
+        return;
+    }
+
+    std::vector<SamplerSound::Ptr> sounds;
+    for (const auto &sample: sampleList) {
+        if (sample->sound != nullptr && sample->sound->isInMemory()
+            && sample->sound->getSourceSampleRate() != sampleRate
+            && !sample->sound->holdsResampledAudio(sampleRate)) {
+            sounds.push_back(sample->sound);
         }
     }
+
+    importer.resampleSounds(sounds, sampleRate);
 }
 
 void SampleManager::removeSamples(int startIdx, int endIdx) {
@@ -91,12 +260,6 @@ void SampleManager::removeSamples(int startIdx, int endIdx) {
         return;
     }
 
-    // Ensure no sounds are playing that might reference these samples
-    sampler.allNotesOff(0, true);
-
-    // Clear the sound registrations first to avoid dangling pointers
-    clearSoundRegistrations();
-
     // Remove samples from back to front to avoid index shifting problems
     for (int i = endIdx; i >= startIdx; --i) {
         if (i < sampleList.size())  // Extra safety check
@@ -106,24 +269,16 @@ void SampleManager::removeSamples(int startIdx, int endIdx) {
                 removeSampleFromGroup(i);
             }
 
-            // Clear the sound and release memory
-            sampleList[i]->sound.release();
+            // Voices may still be playing it, the sound is freed once they are done
+            retiredSounds.push_back(std::move(sampleList[i]->sound));
             sampleList.erase(sampleList.begin() + i);
         }
     }
 
     rebuildSounds();
-
-    // Update valid samples lists for all rates since we removed samples
-    for (int i = 0; i < Models::NUM_RATE_OPTIONS; ++i) {
-        updateValidSamplesForRate(static_cast<Models::RateOption>(i));
-    }
 }
 
 void SampleManager::rebuildSounds() {
-    // Clear the sampler and all sound registrations
-    sampler.clearSounds();
-
     // Rebuild with properly indexed sounds
     for (size_t i = 0; i < sampleList.size(); ++i) {
         sampleList[i]->index = i;
@@ -136,12 +291,11 @@ void SampleManager::rebuildSounds() {
             // Make sure the group index on the SamplerSound matches the SampleInfo
             int groupIndex = sampleList[i]->groupIndex;
             sound->setGroupIndex(groupIndex);
-
-            sampler.addSound(sound);
-            registerSoundWithIndex(sound, i);
         }
     }
 
+    publishSampleSet();
+
     // Update selection
     if (sampleList.empty()) {
         currentSelectedSample = -1;
@@ -151,15 +305,13 @@ void SampleManager::rebuildSounds() {
 }
 
 void SampleManager::clearAllSamples() {
-    // Stop all playing notes first to avoid references to deleted samples
-    sampler.allNotesOff(0, true);
-
-    // Clear the sounds from the sampler - this will delete the SamplerSound objects
-    sampler.clearSounds();
+    // Files still being imported would otherwise land after the clear
+    importer.cancelAll();
 
-    // Clear our sound registration map before clearing the sample list
-    // to avoid any dangling pointers
-    clearSoundRegistrations();
+    // Notes that are still playing keep their sounds until they end
+    for (auto &sample: sampleList) {
+        retiredSounds.push_back(std::move(sample->sound));
+    }
 
     // Clear all groups
     groups.clear();
@@ -167,21 +319,22 @@ void SampleManager::clearAllSamples() {
     // Finally clear the sample list
     sampleList.clear();
     currentSelectedSample = -1;
-    currentPlayIndex = -1;
-    isAscending = true;
 
-    // Clear all valid samples
-    validSamplesForRate.clear();
+    publishSampleSet();
 }
 
 int SampleManager::getNextSampleIndex(Models::RateOption currentRate) {
-    const auto &validSamples = getValidSamplesForRate(currentRate);
+    auto sampleSet = voiceState.readSampleSet();
+    if (!sampleSet)
+        return -1;
+
+    const auto &validSamples = sampleSet->getValidSamplesForRate(currentRate);
 
     if (validSamples.empty())
         return -1;
 
     // If only one valid sample, always return it
-    if (validSamples.size() == 1 && getSampleProbability(validSamples[0]) > 0.0f)
+    if (validSamples.size() == 1 && sampleSet->getSampleProbability(validSamples[0]) > 0.0f)
         return validSamples[0];
 
     // Find the current play index in the valid samples list
@@ -238,46 +391,28 @@ int SampleManager::getNextSampleIndex(Models::RateOption currentRate) {
 
         case Models::RANDOM: // Random selection with probability
         {
-            // Use more reliable random selection logic
-            std::random_device rd;
-            std::mt19937 gen(rd() + juce::Random::getSystemRandom().nextInt64());
-            
-            // First check if there are any samples with non-zero probability
-            bool hasNonZeroProbability = false;
-            for (int idx : validSamples) {
-                if (getSampleProbability(idx) > 0.0f) {
-                    hasNonZeroProbability = true;
-                    break;
-                }
-            }
-            
-            if (!hasNonZeroProbability) {
+            const auto &selector = sampleSet->getSelectorForRate(currentRate);
+            if (!selector.canPick()) {
                 return -1; // No samples with non-zero probability
             }
-            
+
             // Try to avoid consecutive repeats in random mode
             int previousIndex = currentPlayIndex;
             int result;
-            
+
             // If we have more than one valid sample, try to avoid playing the same sample twice
             if (validSamples.size() > 1) {
                 int attempts = 0;
                 do {
-                    result = selectRandomSampleWithProbability(validSamples);
+                    result = selector.pick(random.nextDouble(), random.nextDouble());
                     attempts++;
                     // Only try a limited number of times to avoid infinite loops
                     // if there's only one sample with non-zero probability
                 } while (result == previousIndex && attempts < 3 && result >= 0);
             } else {
-                result = selectRandomSampleWithProbability(validSamples);
-            }
-            
-            // If no valid samples with non-zero probability, return -1 to indicate don't play anything
-            if (result == -1) {
-                return -1; // Signal not to play anything
+                result = selector.pick(random.nextDouble(), random.nextDouble());
             }
-            
-            // Update index and return
+
             return result;
         }
     }
@@ -287,170 +422,6 @@ int SampleManager::getNextSampleIndex(Models::RateOption currentRate) {
     return currentPlayIndex;
 }
 
-int SampleManager::selectRandomSampleWithProbability(const std::vector<int> &validSamples) {
-    if (validSamples.empty()) {
-        return 0;
-    }
-
-    // Filter out samples with zero probability first
-    std::vector<int> samplesWithProbability;
-    for (int idx: validSamples) {
-        if (getSampleProbability(idx) > 0.0f) {
-            samplesWithProbability.push_back(idx);
-        }
-    }
-
-    // If no samples have probability > 0, return -1 to indicate no valid sample
-    if (samplesWithProbability.empty()) {
-        return -1; // No valid samples with non-zero probability
-    }
-
-    // Group valid samples by their group
-    std::map<int, std::vector<int>> groupedValidSamples;
-    float totalGroupProbability = 0.0f;
-
-    // Organize valid samples by group and calculate total group probability
-    organizeValidSamplesByGroup(samplesWithProbability, groupedValidSamples, totalGroupProbability);
-
-    if (totalGroupProbability > 0.0f) {
-        return selectFromGroupedSamples(groupedValidSamples, totalGroupProbability);
-    }
-
-    return -1;
-}
-
-void SampleManager::organizeValidSamplesByGroup(const std::vector<int> &validSamples,
-                                                std::map<int, std::vector<int>> &groupedValidSamples,
-                                                float &totalGroupProbability) {
-    // First pass: organize valid samples by group and calculate total group probability
-    for (int idx: validSamples) {
-        int groupIdx = sampleList[idx]->groupIndex;
-        // Add to appropriate group (including ungrouped samples which have groupIndex = -1)
-        groupedValidSamples[groupIdx].push_back(idx);
-
-        // Add the group probability once per group
-        if (groupedValidSamples[groupIdx].size() == 1) {
-            totalGroupProbability += getGroupProbability(groupIdx);
-        }
-    }
-}
-
-int SampleManager::selectFromGroupedSamples(const std::map<int, std::vector<int>> &groupedValidSamples,
-                                            float totalGroupProbability) {
-    // STEP 1: Select a group based on group probability
-    int selectedGroupIdx = selectGroup(groupedValidSamples, totalGroupProbability);
-
-    // STEP 2: Select a sample from the chosen group
-    if (!groupedValidSamples.at(selectedGroupIdx).empty()) {
-        return selectSampleFromGroup(groupedValidSamples.at(selectedGroupIdx));
-    }
-
-    // If all attempts failed, return -1
-    return -1;
-}
-
-int SampleManager::selectGroup(const std::map<int, std::vector<int>> &groupedValidSamples,
-                               float totalGroupProbability) {
-
-    if (groupedValidSamples.size() == 1) {
-        // Only one group, return it
-        return groupedValidSamples.begin()->first;
-    }
-
-    // Create a vector of pairs (groupIdx, probability) for unbiased selection
-    std::vector<std::pair<int, float>> groupProbabilities;
-    for (const auto &[groupIdx, samples]: groupedValidSamples) {
-        float probability = getGroupProbability(groupIdx);
-        if (probability > 0.0f) {
-            groupProbabilities.emplace_back(groupIdx, probability);
-        }
-    }
-
-    // If no groups with non-zero probability, return -1
-    if (groupProbabilities.empty()) {
-        return -1;
-    }
-
-    // Use a proper generator with proper distribution instead of biased approaches
-    std::random_device rd;
-    std::mt19937 gen(rd() + juce::Random::getSystemRandom().nextInt64());
-
-    // Check for equal probabilities case - if all groups have the same probability
-    bool allEqual = true;
-    float firstProb = groupProbabilities[0].second;
-    for (size_t i = 1; i < groupProbabilities.size(); ++i) {
-        if (std::abs(groupProbabilities[i].second - firstProb) > 0.0001f) {
-            allEqual = false;
-            break;
-        }
-    }
-
-    // If all probabilities are equal, just use uniform distribution
-    if (allEqual) {
-        std::uniform_int_distribution<> distrib(0, groupProbabilities.size() - 1);
-        int randomIndex = distrib(gen);
-        return groupProbabilities[randomIndex].first;
-    }
-
-    std::vector<float> weights;
-    weights.reserve(groupProbabilities.size());
-    for (const auto& pair : groupProbabilities) {
-        weights.push_back(pair.second);
-    }
-    
-    std::discrete_distribution<> distribution(weights.begin(), weights.end());
-    int selectedIndex = distribution(gen);
-    return groupProbabilities[selectedIndex].first;
-}
-
-int SampleManager::selectSampleFromGroup(const std::vector<int> &samplesInGroup) {
-    // Calculate total probability for samples in this group
-    std::vector<std::pair<int, float>> sampleProbabilities;
-
-    for (int idx: samplesInGroup) {
-        float prob = getSampleProbability(idx);
-        sampleProbabilities.emplace_back(idx, prob);
-    }
-
-    // If there are no samples with probability, return -1
-    if (sampleProbabilities.empty()) {
-        return -1;
-    }
-
-    // Use a proper generator with proper distribution
-    std::random_device rd;
-    std::mt19937 gen(rd() + juce::Random::getSystemRandom().nextInt64());
-
-    // Check for equal probabilities case
-    bool allEqual = true;
-    float firstProb = sampleProbabilities[0].second;
-    for (size_t i = 1; i < sampleProbabilities.size(); ++i) {
-        if (std::abs(sampleProbabilities[i].second - firstProb) > 0.0001f) {
-            allEqual = false;
-            break;
-        }
-    }
-
-    // If all probabilities are equal, just use uniform distribution
-    if (allEqual) {
-        std::uniform_int_distribution<> distrib(0, sampleProbabilities.size() - 1);
-        int randomIndex = distrib(gen);
-        return sampleProbabilities[randomIndex].first;
-    }
-
-    // Use discrete distribution for weighted random selection
-    // Extract just the probability values for the distribution
-    std::vector<float> weights;
-    weights.reserve(sampleProbabilities.size());
-    for (const auto& pair : sampleProbabilities) {
-        weights.push_back(pair.second);
-    }
-    
-    std::discrete_distribution<> distribution(weights.begin(), weights.end());
-    int selectedIndex = distribution(gen);
-    return sampleProbabilities[selectedIndex].first;
-}
-
 juce::String SampleManager::getSampleName(int index) const {
     if (index >= 0 && index < sampleList.size())
         return sampleList[index]->name;
@@ -464,6 +435,19 @@ SamplerSound *SampleManager::getSampleSound(int index) const {
     return nullptr;
 }
 
+void SampleManager::setSampleMarkerPositions(int sampleIndex, float start, float end) {
+    if (auto *sound = getSampleSound(sampleIndex)) {
+        sound->setMarkerPositions(start, end);
+
+        if (sound->needsStreamHead()) {
+            importer.primeStreamHeads({sound});
+            if (!isTimerRunning()) {
+                startTimer(retiredSoundPollMs);
+            }
+        }
+    }
+}
+
 juce::File SampleManager::getSampleFilePath(int index) const {
     if (index >= 0 && index < sampleList.size())
         return sampleList[index]->file;
@@ -494,6 +478,7 @@ void SampleManager::createGroup(const juce::Array<int> &sampleIndices) {
 
     // Add the group
     groups.push_back(std::move(newGroup));
+    publishSampleSet();
 }
 
 void SampleManager::removeGroup(int groupIndex) {
@@ -527,6 +512,8 @@ void SampleManager::removeGroup(int groupIndex) {
             }
         }
     }
+
+    publishSampleSet();
 }
 
 const SampleManager::Group *SampleManager::getGroup(int index) const {
@@ -539,6 +526,7 @@ void SampleManager::setSampleProbability(int sampleIndex, float probability) {
     if (sampleIndex >= 0 && sampleIndex < sampleList.size()) {
         // Clamp probability between 0.0 and 1.0
         sampleList[sampleIndex]->probability = juce::jlimit(0.0f, 1.0f, probability);
+        publishSampleSet();
     }
 }
 
@@ -552,6 +540,7 @@ void SampleManager::setGroupProbability(int groupIndex, float probability) {
     if (groupIndex >= 0 && groupIndex < groups.size()) {
         // Clamp probability between 0.0 and 1.0
         groups[groupIndex]->probability = juce::jlimit(0.0f, 1.0f, probability);
+        publishSampleSet();
     }
 }
 
@@ -591,15 +580,15 @@ void SampleManager::removeSampleFromGroup(int sampleIndex) {
     // If the group is now empty, remove it
     if (sampleIndices.empty())
         removeGroup(groupIndex);
+    else
+        publishSampleSet();
 }
 
 void SampleManager::setSampleRateEnabled(int sampleIndex, Models::RateOption rate, bool enabled) {
     if (sampleIndex >= 0 && sampleIndex < sampleList.size()) {
         auto &sample = sampleList[sampleIndex];
         sample->rateEnabled[rate] = enabled;
-
-        // Update the valid samples list for this rate
-        updateValidSamplesForRate(rate);
+        publishSampleSet();
     }
 }
 
@@ -622,36 +611,12 @@ bool SampleManager::isSampleRateEnabled(int sampleIndex, Models::RateOption rate
     return false;
 }
 
-void SampleManager::updateValidSamplesForRate(Models::RateOption rate) {
-    // Clear the vector for this rate (creates it if it doesn't exist)
-    validSamplesForRate[rate].clear();
-
-    // Add all valid samples for this rate
-    for (size_t i = 0; i < sampleList.size(); ++i) {
-        if (isSampleRateEnabled(i, rate)) {
-            validSamplesForRate[rate].push_back(i);
-        }
-    }
-}
-
-const std::vector<int> &SampleManager::getValidSamplesForRate(Models::RateOption rate) const {
-    // If the rate exists in the map, return its vector
-    auto it = validSamplesForRate.find(rate);
-    if (it != validSamplesForRate.end()) {
-        return it->second;
-    }
-
-    // Fallback to an empty vector if not found
-    static const std::vector<int> emptyVector;
-    return emptyVector;
-}
-
 // Group rate methods implementation
 void SampleManager::setGroupRateEnabled(int groupIndex, Models::RateOption rate, bool enabled) {
     if (groupIndex >= 0 && groupIndex < groups.size()) {
         auto &group = groups[groupIndex];
         group->rateEnabled[rate] = enabled;
-        updateValidSamplesForRate(rate);
+        publishSampleSet();
     }
 }
 
@@ -676,14 +641,8 @@ void SampleManager::normalizeSamples() {
         auto &sample = sampleList[i];
         if (!sample->sound) continue;
 
-        juce::AudioBuffer<float> *audioData = sample->sound->getAudioData();
-        if (!audioData) continue;
-
         // Find peak across all channels
-        for (int channel = 0; channel < audioData->getNumChannels(); ++channel) {
-            float channelPeak = audioData->getMagnitude(channel, 0, audioData->getNumSamples());
-            samplePeaks[i] = std::max(samplePeaks[i], channelPeak);
-        }
+        samplePeaks[i] = sample->sound->getPeakLevel();
 
         globalPeak = std::max(globalPeak, samplePeaks[i]);
     }
@@ -698,10 +657,8 @@ void SampleManager::normalizeSamples() {
     for (auto &sample: sampleList) {
         if (!sample->sound) continue;
 
-        juce::AudioBuffer<float> *audioData = sample->sound->getAudioData();
-        if (!audioData) continue;
-
-        // Apply same gain to all samples to maintain relative levels
-        audioData->applyGain(globalGain);
+        // Apply same gain to all samples to maintain relative levels. The voices scale while
+        // playing, the data itself may be shared with other instances
+        sample->sound->setPlaybackGain(sample->sound->getPlaybackGain() * globalGain);
     }
 }
\ No newline at end of file
@@ -2,17 +2,23 @@
 
 #include "SamplerSound.h"
 #include "SamplerVoice.h"
+#include "SamplerSynthesiser.h"
 #include "SamplerVoiceState.h"
+#include "SampleStreamer.h"
+#include "SampleImporter.h"
+#include "SamplePool.h"
+#include "SampleSet.h"
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <utility>
 #include <vector>
 #include <memory>
 #include "../../Shared/Models.h"
-#include "OnsetDetector.h"
-#include <map>
+#include "../../Shared/RandomService.h"
 #include <unordered_map>
 
-class SampleManager : public juce::AudioProcessorValueTreeState::Listener {
+class SampleManager : public juce::AudioProcessorValueTreeState::Listener,
+                      private juce::Timer,
+                      private juce::AsyncUpdater {
 public:
     SampleManager(PluginProcessor &processor);
 
@@ -22,7 +28,7 @@ public:
         juce::String name;
         juce::File file;
         int index;
-        std::unique_ptr<SamplerSound> sound;
+        SamplerSound::Ptr sound;
         float probability = 1.0f;
         int groupIndex = -1;
 
@@ -55,8 +61,18 @@ public:
 
     void processAudio(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &processedMidi);
 
+    // Loads a sample on the calling thread, used when restoring state
     void addSample(const juce::File &file);
 
+    // Queues files for import on background threads, they are appended as they finish
+    void importSamples(const juce::Array<juce::File> &files);
+
+    int getNumPendingImports() const { return importer.getNumPending(); }
+
+    juce::String getPendingImportName(int index) const { return importer.getPendingName(index); }
+
+    float getPendingImportProgress(int index) const { return importer.getPendingProgress(index); }
+
     void removeSamples(int startIdx, int endIdx);
 
     void clearAllSamples();
@@ -91,15 +107,18 @@ public:
 
     juce::String getSampleName(int index) const;
 
-    bool isSampleLoaded() const { return !sampleList.empty(); }
+    // Safe from any thread, reflects the sample set the audio thread currently sees
+    bool isSampleLoaded() const { return numPublishedSamples.load(std::memory_order_relaxed) > 0; }
 
-    SamplerSound *getSampleSound(int index) const;
+    // Audio thread: voices still playing, possibly samples that were removed meanwhile
+    bool hasActiveVoices() const { return sampler.hasActiveVoices(); }
 
-    void registerSoundWithIndex(SamplerSound *sound, int index) { voiceState.registerSoundWithIndex(sound, index); }
+    SamplerSound *getSampleSound(int index) const;
 
-    void clearSoundRegistrations() { voiceState.clearSoundRegistrations(); }
+    // Moves a sample's start and end markers, a streaming sample's head is read again in the background
+    void setSampleMarkerPositions(int sampleIndex, float start, float end);
 
-    void prepareToPlay(double sampleRate);
+    void prepareToPlay(double sampleRate, int samplesPerBlock);
 
     void setSampleRateEnabled(int sampleIndex, Models::RateOption rate, bool enabled);
 
@@ -114,40 +133,68 @@ private:
 
     std::vector<std::unique_ptr<Group>> groups;
 
-    juce::Synthesiser sampler;
+    // Declared before the sampler so its streams outlive the voices that use them
+    SampleStreamer streamer;
+
+    SamplerSynthesiser sampler;
 
     SamplerVoiceState voiceState;
 
-    juce::AudioFormatManager formatManager;
+    SampleImporter importer;
 
-    OnsetDetector onsetDetector;
+    juce::SharedResourcePointer<SamplePool> samplePool;
 
     Models::DirectionType sampleDirection = Models::DirectionType::RANDOM;
 
+    // Samples longer than this are streamed from disk instead of being loaded whole
+    static constexpr double streamingThresholdSeconds = 30.0;
+    bool streamLongSamples = true;
+
+    // Opt-in: uncompressed files below the streaming threshold are memory-mapped rather than
+    // decoded into the pool, optionally touching every page up front so the first trigger
+    // does not stall on page faults
+    bool memoryMapSamples = false;
+    bool warmMappedPages = true;
+
+    // Samples that are loaded whole are kept as 16-bit words and decoded by the voices
+    bool compactSamples = false;
+
+    // In-memory samples get a copy at the host rate, rebuilt in the background when it changes
+    std::atomic<bool> resampleToHostRate{true};
+    std::atomic<double> hostSampleRate{0.0};
+
     std::vector<std::unique_ptr<SampleInfo>> sampleList;
 
-    std::unordered_map<Models::RateOption, std::vector<int>> validSamplesForRate;
+    // Removed sounds wait here until no sample set or voice refers to them any more
+    std::vector<SamplerSound::Ptr> retiredSounds;
+    static constexpr int retiredSoundPollMs = 250;
+
+    std::atomic<int> numPublishedSamples{0};
+
+    // The processor's sample selection stream, audio thread only
+    RandomStream &random;
 
     int currentSelectedSample = -1;
     int currentPlayIndex = -1; // Tracks the index for sequential/bidirectional playback
     bool isAscending = true;   // For bidirectional mode
 
-    void updateValidSamplesForRate(Models::RateOption rate);
-
-    const std::vector<int> &getValidSamplesForRate(Models::RateOption rate) const;
-
-    int selectRandomSampleWithProbability(const std::vector<int> &validSamples);
+    SampleImporter::Options getImportOptions() const;
 
-    void organizeValidSamplesByGroup(const std::vector<int> &validSamples,
-                                     std::map<int, std::vector<int>> &groupedValidSamples,
-                                     float &totalGroupProbability);
+    void commitSample(const juce::File &file, std::unique_ptr<SamplerSound> sound);
 
-    int selectFromGroupedSamples(const std::map<int, std::vector<int>> &groupedValidSamples,
-                                 float totalGroupProbability);
+    // Builds an immutable SampleSet from sampleList and groups and hands it to the audio
+    // thread. Every edit that changes what can play ends with this
+    void publishSampleSet();
 
-    int selectGroup(const std::map<int, std::vector<int>> &groupedValidSamples, float totalGroupProbability);
+    // Frees retired sounds nothing refers to any more, and data the live sounds replaced,
+    // and keeps polling while some remain
+    void releaseRetiredSounds();
 
-    int selectSampleFromGroup(const std::vector<int> &samplesInGroup);
+    void timerCallback() override { releaseRetiredSounds(); }
 
+    // Queues a host rate copy for every in-memory sound that does not hold one yet. Another
+    // instance may have built it already, the sound still has to take its reference
+    void resampleSoundsToHostRate();
 
+    void handleAsyncUpdate() override { resampleSoundsToHostRate(); }
 };
@@ -0,0 +1,157 @@
+#include "SamplePool.h"
+#include "OfflineResampler.h"
+#include <juce_cryptography/juce_cryptography.h>
+
+SharedSampleData::Ptr SharedSampleData::decodeFloat(juce::AudioFormatReader &reader) {
+    if (reader.numChannels == 0 || reader.lengthInSamples <= 0) {
+        return nullptr;
+    }
+
+    Ptr data(new SharedSampleData());
+    data->sampleRate = reader.sampleRate;
+    data->audio.setSize(static_cast<int>(reader.numChannels), static_cast<int>(reader.lengthInSamples));
+
+    if (!reader.read(&data->audio, 0, data->audio.getNumSamples(), 0, true, true)) {
+        return nullptr;
+    }
+
+    for (int channel = 0; channel < data->audio.getNumChannels(); ++channel) {
+        data->peak = juce::jmax(data->peak, data->audio.getMagnitude(channel, 0, data->audio.getNumSamples()));
+    }
+
+    return data;
+}
+
+SharedSampleData::Ptr SharedSampleData::decodeCompact(juce::AudioFormatReader &reader,
+                                                      CompactSampleData::Format format) {
+    auto compact = std::make_unique<CompactSampleData>();
+    if (!compact->loadFrom(reader, format, 2)) {
+        return nullptr;
+    }
+
+    Ptr data(new SharedSampleData());
+    data->sampleRate = reader.sampleRate;
+    data->peak = compact->getPeak();
+    data->compactData = std::move(compact);
+    return data;
+}
+
+void SharedSampleData::readFrames(juce::int64 startFrame, int numFrames, float *const *destination,
+                                  int numChannels) const {
+    for (int channel = 0; channel < numChannels; ++channel) {
+        const int sourceChannel = juce::jmin(channel, getNumChannels() - 1);
+        if (compactData != nullptr) {
+            compactData->decode(sourceChannel, startFrame, numFrames, destination[channel]);
+        } else {
+            juce::FloatVectorOperations::copy(destination[channel],
+                                              audio.getReadPointer(sourceChannel, static_cast<int>(startFrame)),
+                                              numFrames);
+        }
+    }
+}
+
+juce::int64 SharedSampleData::getNumFrames() const {
+    return compactData != nullptr ? compactData->getNumFrames() : static_cast<juce::int64>(audio.getNumSamples());
+}
+
+int SharedSampleData::getNumChannels() const {
+    return compactData != nullptr ? compactData->getNumChannels() : audio.getNumChannels();
+}
+
+SharedSampleData::ResampledAudio::Ptr SharedSampleData::getResampledAudio(double rate) const {
+    for (const auto &slot: resampledAudio) {
+        if (auto copy = slot.pin(); copy != nullptr && copy->sampleRate == rate) {
+            return copy;
+        }
+    }
+    return nullptr;
+}
+
+SharedSampleData::ResampledAudio::Ptr SharedSampleData::buildResampledAudio(double targetRate) {
+    // Data already at the target rate plays at unity ratio, compact data is decoded as it plays
+    if (compactData != nullptr || targetRate <= 0.0 || targetRate == sampleRate) {
+        return nullptr;
+    }
+
+    const juce::ScopedLock sl(resampleLock);
+
+    if (auto existing = getResampledAudio(targetRate)) {
+        return existing;
+    }
+
+    // An empty slot, or one whose copy only the slot itself still refers to
+    SharedSnapshotPublisher<ResampledAudio> *freeSlot = nullptr;
+    for (auto &slot: resampledAudio) {
+        const auto *copy = slot.getLatest();
+        if (copy == nullptr || copy->getReferenceCount() == 1) {
+            freeSlot = &slot;
+            break;
+        }
+    }
+
+    // Voices convert at the source rate as they play until a slot frees up
+    if (freeSlot == nullptr) {
+        return nullptr;
+    }
+
+    ResampledAudio::Ptr copy(new ResampledAudio());
+    OfflineResampler::process(audio, sampleRate, copy->frames, targetRate);
+    copy->sampleRate = targetRate;
+    freeSlot->publish(copy);
+    return copy;
+}
+
+bool SharedSampleData::collectRetiredData() {
+    const juce::ScopedLock sl(resampleLock);
+
+    bool retiredLeft = false;
+    for (auto &slot: resampledAudio) {
+        // No sound in any instance wants this rate any more. A voice pinning it meanwhile
+        // keeps it alive in the slot's retired list until its note ends
+        if (const auto *copy = slot.getLatest(); copy != nullptr && copy->getReferenceCount() == 1) {
+            slot.publish(nullptr);
+        }
+        retiredLeft = slot.collectGarbage() || retiredLeft;
+    }
+    return retiredLeft;
+}
+
+juce::String SamplePool::hashFileContents(const juce::File &file) {
+    return juce::SHA256(file).toHexString() + ":" + juce::String(file.getSize());
+}
+
+SharedSampleData::Ptr SamplePool::getOrLoad(const juce::String &key, const Loader &load) {
+    {
+        const juce::ScopedLock sl(lock);
+        if (auto it = entries.find(key); it != entries.end()) {
+            return it->second;
+        }
+    }
+
+    auto data = load();
+    if (data == nullptr) {
+        return nullptr;
+    }
+
+    const juce::ScopedLock sl(lock);
+    return entries.emplace(key, data).first->second;
+}
+
+void SamplePool::releaseUnused() {
+    // New references are only handed out under the lock, so an entry the pool holds alone
+    // cannot be picked up again while it is being freed
+    const juce::ScopedLock sl(lock);
+
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (it->second->getReferenceCount() == 1) {
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+int SamplePool::getNumEntries() const {
+    const juce::ScopedLock sl(lock);
+    return static_cast<int>(entries.size());
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <juce_audio_utils/juce_audio_utils.h>
+#include "CompactSampleData.h"
+#include "SampleAnalysis.h"
+#include "../Util/SharedSnapshotPublisher.h"
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+/**
+ * Decoded PCM and analysis of one sample file, shared by every sound that plays it.
+ * Holds either float frames or compact 16-bit words. Nothing here changes once the data
+ * has been handed to the pool. Copies at host rates are kept per rate, since instances
+ * sharing the data may run at different rates, and each is freed once no sound wants it
+ * and no voice plays it.
+ */
+class SharedSampleData : public juce::ReferenceCountedObject {
+public:
+    using Ptr = juce::ReferenceCountedObjectPtr<SharedSampleData>;
+
+    // Copy of float data converted to the host rate, so voices skip the rate conversion.
+    // Never changes once published
+    struct ResampledAudio : public juce::ReferenceCountedObject {
+        using Ptr = juce::ReferenceCountedObjectPtr<ResampledAudio>;
+
+        juce::AudioBuffer<float> frames;
+        double sampleRate = 0.0;
+    };
+
+    // Reads every channel of the file as float, nullptr if the file is empty or unreadable
+    static Ptr decodeFloat(juce::AudioFormatReader &reader);
+
+    // Reads up to a stereo pair of the file as 16-bit words, nullptr if it could not be read through
+    static Ptr decodeCompact(juce::AudioFormatReader &reader, CompactSampleData::Format format);
+
+    // Empty for compact data
+    [[nodiscard]] const juce::AudioBuffer<float> &getAudio() const { return audio; }
+
+    [[nodiscard]] const CompactSampleData *getCompactData() const { return compactData.get(); }
+
+    [[nodiscard]] bool isCompact() const { return compactData != nullptr; }
+
+    [[nodiscard]] double getSampleRate() const { return sampleRate; }
+
+    [[nodiscard]] juce::int64 getNumFrames() const;
+
+    [[nodiscard]] int getNumChannels() const;
+
+    // Absolute peak across all channels
+    [[nodiscard]] float getPeak() const { return peak; }
+
+    [[nodiscard]] SampleAnalysis::Ptr getAnalysis() const { return analysis; }
+
+    // Only valid before the data is shared
+    void setAnalysis(SampleAnalysis::Ptr newAnalysis) { analysis = std::move(newAnalysis); }
+
+    // Copies or decodes frames of up to numChannels channels, the last channel repeats if there are fewer
+    void readFrames(juce::int64 startFrame, int numFrames, float *const *destination, int numChannels) const;
+
+    // Any thread: the copy converted to rate, nullptr until one has been built for that rate.
+    // Voices keep the reference for their whole note
+    [[nodiscard]] ResampledAudio::Ptr getResampledAudio(double rate) const;
+
+    // Converts float data to targetRate on the calling thread, never call from the audio thread.
+    // Sounds in every instance at that rate pick the copy up, so the conversion runs once per
+    // process. The caller holds the returned reference for as long as it wants the copy kept.
+    // nullptr when there is nothing to convert or every rate slot is in use
+    ResampledAudio::Ptr buildResampledAudio(double targetRate);
+
+    // Frees copies no sound wants and no voice plays any more, returns true while some wait on voices
+    bool collectRetiredData();
+
+private:
+    SharedSampleData() = default;
+
+    juce::AudioBuffer<float> audio;
+    std::unique_ptr<CompactSampleData> compactData;
+    double sampleRate = 0.0;
+    float peak = 0.0f;
+    SampleAnalysis::Ptr analysis;
+
+    // One slot per host rate in use, a slot is only reused once nothing refers to its copy
+    static constexpr int maxResampledRates = 4;
+    SharedSnapshotPublisher<ResampledAudio> resampledAudio[maxResampledRates];
+    juce::CriticalSection resampleLock; // Builds run on worker threads, collection on every instance's message thread
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SharedSampleData)
+};
+
+/**
+ * Process-wide cache of decoded samples keyed by a hash of the file's contents, so every
+ * plugin instance that loads the same kit shares one copy of it. Reach it through a
+ * juce::SharedResourcePointer. An entry lives while any sound still holds its data.
+ */
+class SamplePool {
+public:
+    using Loader = std::function<SharedSampleData::Ptr()>;
+
+    // Identifies the file by its contents, copies of a file at different paths get the same key
+    static juce::String hashFileContents(const juce::File &file);
+
+    // Returns the data stored under key, or runs load and stores its result. Loads run outside
+    // the lock, two threads missing the same key at once both decode and the first one wins
+    SharedSampleData::Ptr getOrLoad(const juce::String &key, const Loader &load);
+
+    // Frees data that no sound in any instance refers to any more
+    void releaseUnused();
+
+    [[nodiscard]] int getNumEntries() const;
+
+private:
+    mutable juce::CriticalSection lock;
+    std::map<juce::String, SharedSampleData::Ptr> entries;
+};
@@ -0,0 +1,103 @@
+#include "SampleSelector.h"
+#include <algorithm>
+#include <map>
+
+void AliasTable::build(const std::vector<float> &weights) {
+    probability.clear();
+    alias.clear();
+
+    double total = 0.0;
+    for (float weight: weights) {
+        total += std::max(0.0f, weight);
+    }
+
+    const auto n = static_cast<int>(weights.size());
+    probability.assign(weights.size(), 1.0f);
+    alias.resize(weights.size());
+
+    // Nothing to weigh by, every column keeps itself
+    if (total <= 0.0) {
+        for (int i = 0; i < n; ++i) {
+            alias[static_cast<size_t>(i)] = i;
+        }
+        return;
+    }
+
+    // Scale so the average weight is 1, then pair each short column with a tall one
+    std::vector<double> scaled(weights.size());
+    std::vector<int> small, large;
+
+    for (int i = 0; i < n; ++i) {
+        alias[static_cast<size_t>(i)] = i;
+        scaled[static_cast<size_t>(i)] = std::max(0.0f, weights[static_cast<size_t>(i)]) * n / total;
+        (scaled[static_cast<size_t>(i)] < 1.0 ? small : large).push_back(i);
+    }
+
+    while (!small.empty() && !large.empty()) {
+        const int shortColumn = small.back();
+        small.pop_back();
+        const int tallColumn = large.back();
+        large.pop_back();
+
+        probability[static_cast<size_t>(shortColumn)] = static_cast<float>(scaled[static_cast<size_t>(shortColumn)]);
+        alias[static_cast<size_t>(shortColumn)] = tallColumn;
+
+        scaled[static_cast<size_t>(tallColumn)] -= 1.0 - scaled[static_cast<size_t>(shortColumn)];
+        (scaled[static_cast<size_t>(tallColumn)] < 1.0 ? small : large).push_back(tallColumn);
+    }
+
+    // Whatever is left over is full up to rounding error
+    for (int column: small) {
+        probability[static_cast<size_t>(column)] = 1.0f;
+    }
+}
+
+int AliasTable::pick(double draw) const {
+    const double scaled = draw * static_cast<double>(probability.size());
+    const int column = std::min(static_cast<int>(scaled), size() - 1);
+
+    return (scaled - column) < probability[static_cast<size_t>(column)] ? column : alias[static_cast<size_t>(column)];
+}
+
+void SampleSelector::build(const std::vector<int> &validSamples,
+                           const std::vector<float> &sampleProbabilities,
+                           const std::vector<int> &sampleGroups,
+                           const std::vector<float> &groupProbabilities) {
+    groups.clear();
+
+    // Only samples that can actually play, ordered by group with the ungrouped ones first
+    std::map<int, std::vector<int>> samplesByGroup;
+    for (int sampleIndex: validSamples) {
+        if (sampleProbabilities[static_cast<size_t>(sampleIndex)] > 0.0f) {
+            samplesByGroup[sampleGroups[static_cast<size_t>(sampleIndex)]].push_back(sampleIndex);
+        }
+    }
+
+    std::vector<float> groupWeights;
+    for (auto &[groupIndex, samples]: samplesByGroup) {
+        const bool grouped = groupIndex >= 0 && groupIndex < static_cast<int>(groupProbabilities.size());
+        const float groupProbability = grouped ? groupProbabilities[static_cast<size_t>(groupIndex)] : 1.0f;
+
+        std::vector<float> sampleWeights;
+        sampleWeights.reserve(samples.size());
+        for (int sampleIndex: samples) {
+            sampleWeights.push_back(sampleProbabilities[static_cast<size_t>(sampleIndex)]);
+        }
+
+        auto &group = groups.emplace_back();
+        group.samples = std::move(samples);
+        group.table.build(sampleWeights);
+        groupWeights.push_back(groupProbability);
+    }
+
+    groupTable.build(groupWeights);
+}
+
+int SampleSelector::pick(double groupDraw, double sampleDraw) const {
+    if (groupTable.isEmpty()) {
+        return -1;
+    }
+
+    const auto &group = groups[static_cast<size_t>(groupTable.pick(groupDraw))];
+    return group.samples[static_cast<size_t>(group.table.pick(sampleDraw))];
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+
+/**
+ * Walker's alias method: after an O(n) build, drawing an index with probability
+ * proportional to its weight costs one uniform number and one table lookup.
+ */
+class AliasTable {
+public:
+    // Entries with zero or negative weight are never drawn, unless no entry has a positive
+    // weight: then every entry is drawn equally often
+    void build(const std::vector<float> &weights);
+
+    [[nodiscard]] bool isEmpty() const { return probability.empty(); }
+
+    [[nodiscard]] int size() const { return static_cast<int>(probability.size()); }
+
+    // Maps a uniform draw in [0, 1) to an entry, the table must not be empty
+    [[nodiscard]] int pick(double draw) const;
+
+private:
+    std::vector<float> probability;
+    std::vector<int> alias;
+};
+
+/**
+ * Random sample choice for one rate: first a group by group probability, then a sample
+ * within it by sample probability. Ungrouped samples count as one group of full probability.
+ * When every group that has playable samples is at zero probability, they are picked evenly.
+ * Built on the message thread with the sample set, picking never allocates.
+ */
+class SampleSelector {
+public:
+    void build(const std::vector<int> &validSamples,
+               const std::vector<float> &sampleProbabilities,
+               const std::vector<int> &sampleGroups,
+               const std::vector<float> &groupProbabilities);
+
+    // False when no valid sample has a probability above zero
+    [[nodiscard]] bool canPick() const { return !groupTable.isEmpty(); }
+
+    // Sample index for two uniform draws in [0, 1), -1 if nothing can be picked
+    [[nodiscard]] int pick(double groupDraw, double sampleDraw) const;
+
+private:
+    struct Group {
+        std::vector<int> samples;
+        AliasTable table;
+    };
+
+    std::vector<Group> groups;
+    AliasTable groupTable;
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include "SamplerSound.h"
+#include "SampleSelector.h"
+#include "../../Shared/Models.h"
+
+/**
+ * Everything the audio thread needs to pick and play a sample, frozen at the moment the
+ * message thread published it. A set is never modified after publishing, every edit builds
+ * a new one, so the audio thread can read it without locks while the UI keeps editing.
+ */
+struct SampleSet {
+    struct Sample {
+        SamplerSound::Ptr sound;
+        float probability = 1.0f;
+        int groupIndex = -1;
+    };
+
+    std::vector<Sample> samples;
+
+    // The samples' sounds by index, one flat array for the voices' lookup at note start.
+    // The references in samples keep them alive
+    std::vector<SamplerSound *> soundTable;
+    std::vector<float> groupProbabilities;
+
+    // Indices of the samples that may play at each rate, group settings already applied
+    std::array<std::vector<int>, Models::NUM_RATE_OPTIONS> validSamplesForRate;
+
+    // Weighted random choice among each rate's valid samples, precomputed at publish time
+    std::array<SampleSelector, Models::NUM_RATE_OPTIONS> selectorForRate;
+
+    [[nodiscard]] int getNumSamples() const { return static_cast<int>(samples.size()); }
+
+    // nullptr for an index outside the set, never some other sample's sound
+    [[nodiscard]] SamplerSound *getSound(int index) const {
+        if (index >= 0 && index < static_cast<int>(soundTable.size())) {
+            return soundTable[static_cast<size_t>(index)];
+        }
+        return nullptr;
+    }
+
+    [[nodiscard]] float getSampleProbability(int index) const {
+        if (index >= 0 && index < getNumSamples()) {
+            return samples[static_cast<size_t>(index)].probability;
+        }
+        return 0.0f;
+    }
+
+    [[nodiscard]] int getGroupIndex(int index) const {
+        if (index >= 0 && index < getNumSamples()) {
+            return samples[static_cast<size_t>(index)].groupIndex;
+        }
+        return -1;
+    }
+
+    // Ungrouped samples act as a group of their own with full probability
+    [[nodiscard]] float getGroupProbability(int groupIndex) const {
+        if (groupIndex >= 0 && groupIndex < static_cast<int>(groupProbabilities.size())) {
+            return groupProbabilities[static_cast<size_t>(groupIndex)];
+        }
+        return 1.0f;
+    }
+
+    [[nodiscard]] const std::vector<int> &getValidSamplesForRate(Models::RateOption rate) const {
+        static const std::vector<int> emptyVector;
+        if (rate >= 0 && rate < Models::NUM_RATE_OPTIONS) {
+            return validSamplesForRate[static_cast<size_t>(rate)];
+        }
+        return emptyVector;
+    }
+
+    [[nodiscard]] const SampleSelector &getSelectorForRate(Models::RateOption rate) const {
+        static const SampleSelector emptySelector;
+        if (rate >= 0 && rate < Models::NUM_RATE_OPTIONS) {
+            return selectorForRate[static_cast<size_t>(rate)];
+        }
+        return emptySelector;
+    }
+};
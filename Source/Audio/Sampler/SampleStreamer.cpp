@@ -0,0 +1,185 @@
+#include "SampleStreamer.h"
+#include "SamplerSound.h"
+
+SampleStream::SampleStream(int numChannels)
+        : ring(std::max(numChannels, 1), capacityFrames) {
+    ring.clear();
+}
+
+void SampleStream::start(SamplerSound *sound, juce::int64 firstFrame) {
+    requestedSound.store(sound, std::memory_order_relaxed);
+    requestedFrame.store(firstFrame, std::memory_order_relaxed);
+    requestGeneration.fetch_add(1, std::memory_order_release);
+    firstBufferedFrame = firstFrame;
+}
+
+void SampleStream::stop() {
+    start(nullptr, 0);
+}
+
+bool SampleStream::isReady() const {
+    return servedGeneration.load(std::memory_order_acquire) == requestGeneration.load(std::memory_order_relaxed);
+}
+
+bool SampleStream::hasPendingRequest() const {
+    return servedGeneration.load(std::memory_order_relaxed) != requestGeneration.load(std::memory_order_acquire);
+}
+
+int SampleStream::getNumBufferedFrames() const {
+    return isReady() ? fifo.getNumReady() : 0;
+}
+
+void SampleStream::copyFrames(juce::int64 firstFrame, int numFrames, int channel, float *destination) const {
+    const int offset = static_cast<int>(firstFrame - firstBufferedFrame);
+    jassert(offset >= 0 && offset + numFrames <= fifo.getNumReady());
+
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(offset + numFrames, start1, size1, start2, size2);
+
+    const float *data = ring.getReadPointer(channel);
+
+    // Skip the first offset frames, which may span the wrap point
+    if (offset < size1) {
+        const int fromFirst = std::min(size1 - offset, numFrames);
+        juce::FloatVectorOperations::copy(destination, data + start1 + offset, fromFirst);
+        if (fromFirst < numFrames) {
+            juce::FloatVectorOperations::copy(destination + fromFirst, data + start2, numFrames - fromFirst);
+        }
+    } else {
+        juce::FloatVectorOperations::copy(destination, data + start2 + (offset - size1), numFrames);
+    }
+}
+
+void SampleStream::discardBefore(juce::int64 frame) {
+    if (!isReady() || frame <= firstBufferedFrame) {
+        return;
+    }
+
+    const int numToDiscard = static_cast<int>(std::min<juce::int64>(frame - firstBufferedFrame, fifo.getNumReady()));
+    fifo.finishedRead(numToDiscard);
+    firstBufferedFrame += numToDiscard;
+}
+
+bool SampleStream::service(juce::AudioBuffer<float> &readScratch) {
+    const auto generation = requestGeneration.load(std::memory_order_acquire);
+
+    if (generation != servedGeneration.load(std::memory_order_relaxed)) {
+        auto *sound = requestedSound.load(std::memory_order_relaxed);
+        const auto frame = requestedFrame.load(std::memory_order_relaxed);
+
+        // The voice issued another request while we were reading this one, pick it up next pass
+        if (requestGeneration.load(std::memory_order_acquire) != generation) {
+            return true;
+        }
+
+        // The consumer does not touch the fifo until servedGeneration matches, so resetting is safe
+        fifo.reset();
+        activeSound = sound;
+        nextFileFrame = frame;
+        servedGeneration.store(generation, std::memory_order_release);
+    }
+
+    if (activeSound == nullptr) {
+        return false;
+    }
+
+    const juce::int64 remaining = activeSound->getLengthInSamples() - nextFileFrame;
+    const int numToRead = static_cast<int>(std::min<juce::int64>({remaining,
+                                                                 fifo.getFreeSpace(),
+                                                                 readScratch.getNumSamples()}));
+
+    // Wait for a reasonably sized gap rather than issuing many tiny reads
+    if (numToRead <= 0 || (numToRead < readScratch.getNumSamples() / 4 && numToRead < remaining)) {
+        return false;
+    }
+
+    const int numChannels = std::min(activeSound->getNumStreamChannels(), ring.getNumChannels());
+    if (!activeSound->readFromDisk(readScratch, 0, numToRead, nextFileFrame)) {
+        readScratch.clear(0, numToRead);
+    }
+
+    // The note changed while the disk read was in flight, the data is stale
+    if (requestGeneration.load(std::memory_order_acquire) != generation) {
+        return true;
+    }
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(numToRead, start1, size1, start2, size2);
+
+    for (int channel = 0; channel < numChannels; ++channel) {
+        const float *source = readScratch.getReadPointer(channel);
+        ring.copyFrom(channel, start1, source, size1);
+        if (size2 > 0) {
+            ring.copyFrom(channel, start2, source + size1, size2);
+        }
+    }
+
+    fifo.finishedWrite(size1 + size2);
+    nextFileFrame += size1 + size2;
+    return true;
+}
+
+//==============================================================================
+
+SampleStreamer::SampleStreamer() : juce::Thread("Sample Streamer") {}
+
+SampleStreamer::~SampleStreamer() {
+    stopThread(2000);
+}
+
+void SampleStreamer::prepare(int numStreams, int numChannels) {
+    if (getNumStreams() == numStreams && readScratch.getNumChannels() == numChannels) {
+        if (!isThreadRunning()) {
+            startThread();
+        }
+        return;
+    }
+
+    stopThread(2000);
+
+    streams.clear();
+    for (int i = 0; i < numStreams; ++i) {
+        streams.push_back(std::make_unique<SampleStream>(numChannels));
+    }
+    readScratch.setSize(numChannels, readBlockFrames);
+
+    startThread();
+}
+
+SampleStream *SampleStreamer::getStream(int index) const {
+    return juce::isPositiveAndBelow(index, getNumStreams()) ? streams[static_cast<size_t>(index)].get() : nullptr;
+}
+
+void SampleStreamer::waitUntilRequestsServed() const {
+    if (!isThreadRunning()) {
+        return;
+    }
+
+    for (const auto &stream: streams) {
+        while (stream->hasPendingRequest() && isThreadRunning()) {
+            juce::Thread::sleep(1);
+        }
+    }
+}
+
+int SampleStreamer::getUnderrunCount() const {
+    int total = 0;
+    for (const auto &stream: streams) {
+        total += stream->getUnderrunCount();
+    }
+    return total;
+}
+
+void SampleStreamer::run() {
+    while (!threadShouldExit()) {
+        bool didWork = false;
+
+        for (auto &stream: streams) {
+            didWork = stream->service(readScratch) || didWork;
+        }
+
+        if (!didWork) {
+            wait(2);
+        }
+    }
+}
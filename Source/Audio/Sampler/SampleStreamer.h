@@ -0,0 +1,107 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class SamplerSound;
+
+/**
+ * Single-producer/single-consumer ring that feeds one voice with audio read from disk.
+ * The voice (consumer) requests a sound and a first frame, the streamer thread (producer)
+ * fills the ring from that frame onwards. Requests are versioned so the voice never reads
+ * frames that were queued for a previous note.
+ */
+class SampleStream {
+public:
+    static constexpr int capacityFrames = 1 << 15;
+
+    explicit SampleStream(int numChannels);
+
+    // Audio thread -------------------------------------------------------------------------
+
+    // Starts streaming sound from firstFrame, frames queued for an earlier request are dropped
+    void start(SamplerSound *sound, juce::int64 firstFrame);
+
+    void stop();
+
+    // True once the streamer has picked up the latest request and frames may be read
+    [[nodiscard]] bool isReady() const;
+
+    // First frame held by the ring, valid while isReady()
+    [[nodiscard]] juce::int64 getFirstBufferedFrame() const { return firstBufferedFrame; }
+
+    [[nodiscard]] int getNumBufferedFrames() const;
+
+    // Copies buffered frames of one channel, the whole range must be buffered
+    void copyFrames(juce::int64 firstFrame, int numFrames, int channel, float *destination) const;
+
+    // Frees every buffered frame before frame so the streamer can refill it
+    void discardBefore(juce::int64 frame);
+
+    void reportUnderrun() { underruns.fetch_add(1, std::memory_order_relaxed); }
+
+    [[nodiscard]] int getUnderrunCount() const { return underruns.load(std::memory_order_relaxed); }
+
+    // Streamer thread ----------------------------------------------------------------------
+
+    // Picks up a new request and tops up the ring, returns false when there was nothing to do
+    bool service(juce::AudioBuffer<float> &readScratch);
+
+    [[nodiscard]] bool hasPendingRequest() const;
+
+private:
+    juce::AudioBuffer<float> ring;
+    juce::AbstractFifo fifo{capacityFrames};
+
+    std::atomic<SamplerSound *> requestedSound{nullptr};
+    std::atomic<juce::int64> requestedFrame{0};
+    std::atomic<juce::uint32> requestGeneration{0};
+    std::atomic<juce::uint32> servedGeneration{0};
+    std::atomic<int> underruns{0};
+
+    // Consumer side
+    juce::int64 firstBufferedFrame = 0;
+
+    // Producer side
+    SamplerSound *activeSound = nullptr;
+    juce::int64 nextFileFrame = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleStream)
+};
+
+/**
+ * Background thread that keeps every voice's SampleStream topped up from disk.
+ * Streams are allocated once in prepare() and handed to voices, so starting and
+ * stopping a streamed note never allocates, locks or touches the file system.
+ */
+class SampleStreamer : private juce::Thread {
+public:
+    SampleStreamer();
+
+    ~SampleStreamer() override;
+
+    // Allocates numStreams streams and starts the thread, must not be called from the audio thread
+    void prepare(int numStreams, int numChannels);
+
+    [[nodiscard]] SampleStream *getStream(int index) const;
+
+    [[nodiscard]] int getNumStreams() const { return static_cast<int>(streams.size()); }
+
+    // Blocks until the streamer has seen every stream's latest request, so sounds that are
+    // no longer requested can be deleted safely
+    void waitUntilRequestsServed() const;
+
+    [[nodiscard]] int getUnderrunCount() const;
+
+private:
+    static constexpr int readBlockFrames = 8192;
+
+    std::vector<std::unique_ptr<SampleStream>> streams;
+    juce::AudioBuffer<float> readScratch;
+
+    void run() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleStreamer)
+};
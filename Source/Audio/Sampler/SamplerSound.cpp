@@ -3,23 +3,313 @@
 //
 
 #include "SamplerSound.h"
+#include <algorithm>
+#include <limits>
 
 SamplerSound::SamplerSound(juce::String soundName,
-                           juce::AudioFormatReader &source,
+                           SharedSampleData::Ptr data,
+                           juce::File file,
                            juce::BigInteger midiNotes)
-        : name(std::move(soundName)), midiNotes(std::move(midiNotes)), sourceSampleRate(source.sampleRate) {
-    if (source.numChannels > 0) {
-        audioData.setSize(source.numChannels, static_cast<int>(source.lengthInSamples));
-        source.read(&audioData,
-                    0,
-                    static_cast<int>(source.lengthInSamples),
-                    0,
-                    true,
-                    true
-        );
+        : name(std::move(soundName)), sharedData(std::move(data)), midiNotes(std::move(midiNotes)),
+          sourceSampleRate(sharedData->getSampleRate()), sourceFile(std::move(file)) {
+    lengthInSamples = sharedData->getNumFrames();
+    streamChannels = sharedData->getNumChannels();
+    filePeakLevel = sharedData->getPeak();
+    analysis = sharedData->getAnalysis();
+    if (analysis != nullptr) {
+        publishSlices(analysis->onsetMarkers);
+        publishBeatGrid(analysis->beatGrid);
     }
 }
 
+SamplerSound::SamplerSound(juce::String soundName,
+                           std::unique_ptr<juce::AudioFormatReader> streamReader,
+                           juce::File file,
+                           juce::BigInteger midiNotes)
+        : name(std::move(soundName)), midiNotes(std::move(midiNotes)), sourceSampleRate(streamReader->sampleRate),
+          streaming(true), sourceFile(std::move(file)), diskReader(std::move(streamReader)) {
+    lengthInSamples = diskReader->lengthInSamples;
+    streamChannels = juce::jmin(2, static_cast<int>(diskReader->numChannels));
+
+    measureFilePeak(*diskReader);
+    primeStreamHead();
+}
+
+SamplerSound::SamplerSound(juce::String soundName,
+                           std::unique_ptr<juce::MemoryMappedAudioFormatReader> reader,
+                           juce::BigInteger midiNotes)
+        : name(std::move(soundName)), midiNotes(std::move(midiNotes)), sourceSampleRate(reader->sampleRate),
+          sourceFile(reader->getFile()), mappedReader(std::move(reader)) {
+    lengthInSamples = mappedReader->lengthInSamples;
+    streamChannels = juce::jmin(2, static_cast<int>(mappedReader->numChannels));
+
+    measureFilePeak(*mappedReader);
+}
+
+void SamplerSound::measureFilePeak(juce::AudioFormatReader &reader) {
+    // The peak is needed for normalisation, measure it once while the file is being opened
+    std::vector<juce::Range<float>> levels(reader.numChannels);
+    reader.readMaxLevels(0, lengthInSamples, levels.data(), static_cast<int>(levels.size()));
+    for (const auto &range: levels) {
+        filePeakLevel = juce::jmax(filePeakLevel, std::abs(range.getStart()), std::abs(range.getEnd()));
+    }
+}
+
+void SamplerSound::readMappedFrames(juce::int64 startFrame, int numFrames, float *const *destination,
+                                    int numChannels) {
+    mappedReader->read(destination, numChannels, startFrame, numFrames);
+}
+
+void SamplerSound::readCompactFrames(juce::int64 startFrame, int numFrames, float *const *destination,
+                                     int numChannels) const {
+    const auto *compactData = sharedData->getCompactData();
+    for (int channel = 0; channel < numChannels; ++channel) {
+        compactData->decode(juce::jmin(channel, compactData->getNumChannels() - 1), startFrame, numFrames,
+                            destination[channel]);
+    }
+}
+
+void SamplerSound::warmMappedPages() const {
+    if (mappedReader == nullptr) {
+        return;
+    }
+
+    constexpr juce::int64 pageSize = 4096;
+    const auto bytesPerFrame = static_cast<juce::int64>(mappedReader->bitsPerSample / 8 * mappedReader->numChannels);
+    const juce::int64 framesPerPage = juce::jmax<juce::int64>(1, pageSize / juce::jmax<juce::int64>(1, bytesPerFrame));
+
+    for (juce::int64 frame = 0; frame < lengthInSamples; frame += framesPerPage) {
+        mappedReader->touchSample(frame);
+    }
+}
+
+void SamplerSound::setMarkerPositions(float start, float end) {
+    // Streaming sounds only play once primeStreamHead has caught up with a new start
+    const float newStart = juce::jlimit(0.0f, 0.99f, start);
+    const float newEnd = juce::jlimit(newStart + 0.01f, 1.0f, end);
+    const bool changed = newStart != getStartMarkerPosition() || newEnd != getEndMarkerPosition();
+
+    startMarkerPosition.store(newStart, std::memory_order_relaxed);
+    endMarkerPosition.store(newEnd, std::memory_order_relaxed);
+
+    // Slices are cut to the region between the markers
+    if (changed && !streaming && !getOnsetMarkers().empty()) {
+        publishSlices(getOnsetMarkers());
+    }
+}
+
+const std::vector<float> &SamplerSound::getOnsetMarkers() const {
+    static const std::vector<float> noMarkers;
+    const auto *table = sliceTables.getLatest();
+    return table != nullptr ? table->onsetMarkers : noMarkers;
+}
+
+void SamplerSound::setOnsetMarkers(const std::vector<float> &markers) {
+    publishSlices(markers);
+}
+
+void SamplerSound::clearOnsetMarkers() {
+    publishSlices({});
+}
+
+void SamplerSound::setAnalysis(SampleAnalysis::Ptr newAnalysis) {
+    analysis = std::move(newAnalysis);
+    publishBeatGrid(analysis != nullptr ? analysis->beatGrid : BeatGrid{});
+
+    if (analysis != nullptr && getOnsetMarkers().empty()) {
+        setOnsetMarkers(analysis->onsetMarkers);
+    }
+}
+
+void SamplerSound::publishBeatGrid(const BeatGrid &grid) {
+    const int nextGrid = 1 - activeBeatGrid.load(std::memory_order_relaxed);
+    beatGrids[nextGrid] = grid;
+    activeBeatGrid.store(nextGrid, std::memory_order_release);
+}
+
+int SamplerSound::nextSequentialSlice(int numSlices) {
+    if (sequentialSlice >= numSlices) {
+        sequentialSlice = 0;
+    }
+    return sequentialSlice++;
+}
+
+void SamplerSound::publishSlices(const std::vector<float> &onsetMarkers) {
+    SliceTable::Ptr table(new SliceTable());
+    table->onsetMarkers = onsetMarkers;
+    auto &slices = table->slices;
+
+    if (!streaming && lengthInSamples > 0 && !onsetMarkers.empty()) {
+        // Same arithmetic as the voice uses for the start and end of a whole note
+        const auto regionStart = static_cast<juce::int64>(static_cast<double>(lengthInSamples) * getStartMarkerPosition());
+        const auto regionEnd = static_cast<juce::int64>(static_cast<double>(lengthInSamples) * getEndMarkerPosition());
+
+        std::vector<juce::int64> boundaries{regionStart, regionEnd};
+        for (float marker: onsetMarkers) {
+            const auto frame = static_cast<juce::int64>(static_cast<double>(lengthInSamples) * marker);
+            if (frame > regionStart && frame < regionEnd) {
+                boundaries.push_back(juce::jlimit(regionStart, regionEnd, findNearestZeroCrossing(frame)));
+            }
+        }
+        std::sort(boundaries.begin(), boundaries.end());
+
+        // Slices too short for both ramps are dropped rather than clicking
+        const int rampFrames = juce::jmax(1, static_cast<int>(sliceRampSeconds * sourceSampleRate));
+        for (size_t i = 0; i + 1 < boundaries.size(); ++i) {
+            if (boundaries[i + 1] - boundaries[i] >= 2 * rampFrames) {
+                slices.push_back({boundaries[i], boundaries[i + 1], rampFrames});
+            }
+        }
+    }
+
+    sliceTables.publish(std::move(table));
+}
+
+void SamplerSound::readAnalysisFrames(juce::int64 startFrame, int numFrames, float *const *destination,
+                                      int numChannels) {
+    if (sharedData != nullptr) {
+        sharedData->readFrames(startFrame, numFrames, destination, numChannels);
+    } else if (mappedReader != nullptr) {
+        mappedReader->read(destination, numChannels, startFrame, numFrames);
+    } else if (streaming) {
+        const juce::ScopedLock lock(diskReaderLock);
+        diskReader->read(destination, numChannels, startFrame, numFrames);
+    } else {
+        for (int channel = 0; channel < numChannels; ++channel) {
+            juce::FloatVectorOperations::clear(destination[channel], numFrames);
+        }
+    }
+}
+
+juce::int64 SamplerSound::findNearestZeroCrossing(juce::int64 frame) {
+    const auto searchFrames = static_cast<juce::int64>(zeroCrossingSearchSeconds * sourceSampleRate);
+    const juce::int64 windowStart = juce::jmax<juce::int64>(0, frame - searchFrames);
+    const juce::int64 windowEnd = juce::jmin(lengthInSamples, frame + searchFrames + 1);
+
+    std::vector<float> window(static_cast<size_t>(windowEnd - windowStart));
+    float *windowData = window.data();
+    readAnalysisFrames(windowStart, static_cast<int>(window.size()), &windowData, 1);
+
+    juce::int64 nearest = frame;
+    juce::int64 nearestDistance = std::numeric_limits<juce::int64>::max();
+
+    for (size_t i = 1; i < window.size(); ++i) {
+        if ((window[i - 1] < 0.0f) == (window[i] < 0.0f) && window[i] != 0.0f) {
+            continue;
+        }
+
+        // Of the two frames around the crossing, start on the quieter one
+        const size_t quieter = std::abs(window[i - 1]) < std::abs(window[i]) ? i - 1 : i;
+        const juce::int64 candidate = windowStart + static_cast<juce::int64>(quieter);
+        const juce::int64 distance = std::abs(candidate - frame);
+
+        if (distance < nearestDistance) {
+            nearest = candidate;
+            nearestDistance = distance;
+        }
+    }
+
+    return nearest;
+}
+
+juce::int64 SamplerSound::getStreamHeadStartFrame() const {
+    // Same arithmetic as the voice uses for its start position, less a few guard frames
+    // so the interpolator's leading taps are in memory too
+    const auto startFrame = static_cast<juce::int64>(static_cast<double>(lengthInSamples) * getStartMarkerPosition());
+    return juce::jmax<juce::int64>(0, startFrame - streamHeadGuardFrames);
+}
+
+bool SamplerSound::needsStreamHead() const {
+    if (!streaming) {
+        return false;
+    }
+
+    const juce::ScopedLock sl(streamHeadLock);
+    const auto *head = streamHeads.getLatest();
+    return head == nullptr || head->startFrame != getStreamHeadStartFrame();
+}
+
+void SamplerSound::primeStreamHead() {
+    // Primes queued for several marker moves run one after another, later ones find the head current
+    const juce::ScopedLock sl(streamHeadLock);
+    if (!needsStreamHead()) {
+        return;
+    }
+
+    StreamHead::Ptr head(new StreamHead());
+    head->startFrame = getStreamHeadStartFrame();
+
+    const auto headFrames = static_cast<juce::int64>(streamHeadSeconds * sourceSampleRate) + streamHeadGuardFrames;
+    const int numFrames = static_cast<int>(juce::jmin(lengthInSamples - head->startFrame, headFrames));
+    head->frames.setSize(streamChannels, numFrames);
+
+    for (int frame = 0; frame < numFrames; frame += streamHeadReadBlockFrames) {
+        const int blockFrames = juce::jmin(streamHeadReadBlockFrames, numFrames - frame);
+        if (!readFromDisk(head->frames, frame, blockFrames, head->startFrame + frame)) {
+            head->frames.clear();
+            break;
+        }
+    }
+
+    streamHeads.publish(std::move(head));
+}
+
+bool SamplerSound::collectRetiredData() {
+    const bool slicesLeft = sliceTables.collectGarbage();
+    const bool resampledLeft = sharedData != nullptr && sharedData->collectRetiredData();
+
+    const juce::ScopedLock sl(streamHeadLock);
+    return streamHeads.collectGarbage() || slicesLeft || resampledLeft;
+}
+
+bool SamplerSound::readFromDisk(juce::AudioBuffer<float> &destination, int destStartFrame, int numFrames,
+                                juce::int64 fileStartFrame) {
+    const juce::ScopedLock lock(diskReaderLock);
+
+    if (diskReader == nullptr) {
+        return false;
+    }
+
+    return diskReader->read(&destination, destStartFrame, numFrames, fileStartFrame, true, true);
+}
+
+const juce::AudioBuffer<float> *SamplerSound::getAudioData() const {
+    static const juce::AudioBuffer<float> noAudio;
+    return isInMemory() ? &sharedData->getAudio() : &noAudio;
+}
+
+SamplerSound::ResampledAudio::Ptr SamplerSound::getResampledAudio(double sampleRate) const {
+    return isInMemory() ? sharedData->getResampledAudio(sampleRate) : nullptr;
+}
+
+void SamplerSound::buildResampledAudio(double targetRate) {
+    if (!isInMemory()) {
+        return;
+    }
+
+    {
+        const juce::ScopedLock sl(hostRateLock);
+        hostRate = targetRate;
+    }
+
+    auto copy = sharedData->buildResampledAudio(targetRate);
+
+    // A build queued for an earlier rate may finish after the current one
+    const juce::ScopedLock sl(hostRateLock);
+    if (hostRate == targetRate) {
+        hostRateCopy = std::move(copy);
+    }
+}
+
+bool SamplerSound::holdsResampledAudio(double sampleRate) const {
+    const juce::ScopedLock sl(hostRateLock);
+    return hostRateCopy != nullptr && hostRateCopy->sampleRate == sampleRate;
+}
+
+float SamplerSound::getPeakLevel() {
+    return filePeakLevel * getPlaybackGain();
+}
+
 bool SamplerSound::appliesToNote(int midiNoteNumber) {
     return midiNotes[midiNoteNumber];
 }
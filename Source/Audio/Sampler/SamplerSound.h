@@ -6,18 +6,147 @@
 #define COINCIDENCE_SAMPLERSOUND_H
 
 #include <juce_audio_utils/juce_audio_utils.h>
+#include "SamplePool.h"
+#include "../Util/SharedSnapshotPublisher.h"
+#include <atomic>
+#include <memory>
 
 class SamplerSound : public juce::SynthesiserSound {
 public:
+    using Ptr = juce::ReferenceCountedObjectPtr<SamplerSound>;
+
+    // In-memory sound: plays data decoded once per process and shared through the SamplePool,
+    // either float frames or 16-bit words the voices decode as they play
+    SamplerSound(juce::String name,
+                 SharedSampleData::Ptr data,
+                 juce::File sourceFile,
+                 juce::BigInteger notes);
+
+    // Streaming sound: only a short head from the start marker is held in memory, the
+    // rest is read from disk by the SampleStreamer while a voice plays it
     SamplerSound(juce::String name,
-                 juce::AudioFormatReader &source,
+                 std::unique_ptr<juce::AudioFormatReader> streamReader,
+                 juce::File sourceFile,
                  juce::BigInteger notes);
 
+    // Memory-mapped sound: frames are converted straight out of the mapped file, so the OS
+    // pages them in on demand and shares them between every instance that maps the same file.
+    // There is no pool data behind it, so it never gets a host-rate copy
+    SamplerSound(juce::String name,
+                 std::unique_ptr<juce::MemoryMappedAudioFormatReader> mappedReader,
+                 juce::BigInteger notes);
+
+    // Frames kept in memory ahead of the start marker, this covers the time the streamer
+    // needs to start filling a voice's ring
+    static constexpr double streamHeadSeconds = 1.0;
+    static constexpr int streamHeadGuardFrames = 8;
+
+    // Never changes once published, a marker move publishes a new head instead
+    struct StreamHead : public juce::ReferenceCountedObject {
+        using Ptr = juce::ReferenceCountedObjectPtr<StreamHead>;
+
+        juce::AudioBuffer<float> frames;
+        juce::int64 startFrame = 0;
+
+        [[nodiscard]] juce::int64 getEndFrame() const { return startFrame + frames.getNumSamples(); }
+    };
+
+    using ResampledAudio = SharedSampleData::ResampledAudio;
+
+    // A stretch between two onsets, played on its own in slice playback
+    struct Slice {
+        juce::int64 startFrame = 0; // Moved onto the nearest zero crossing when there is one close by
+        juce::int64 endFrame = 0;
+        int rampFrames = 0;         // Declick fade at either end
+    };
+
+    // Onset markers and the slices between them, cut to the region between the start and end
+    // markers. Never changes once published, editing any marker publishes a new table
+    struct SliceTable : public juce::ReferenceCountedObject {
+        using Ptr = juce::ReferenceCountedObjectPtr<SliceTable>;
+
+        std::vector<float> onsetMarkers; // Positions from 0.0 to 1.0
+        std::vector<Slice> slices;
+    };
+
+    static constexpr double sliceRampSeconds = 0.002;
+    static constexpr double zeroCrossingSearchSeconds = 0.003;
+
     bool appliesToNote(int midiNoteNumber) override;
 
     bool appliesToChannel(int midiChannel) override;
 
-    juce::AudioBuffer<float> *getAudioData() { return &audioData; }
+    // Whole sample in memory as float, empty for every other kind of sound. Shared with other
+    // instances, so it is never modified
+    const juce::AudioBuffer<float> *getAudioData() const;
+
+    bool isStreaming() const { return streaming; }
+
+    bool isMemoryMapped() const { return mappedReader != nullptr; }
+
+    bool isCompact() const { return sharedData != nullptr && sharedData->isCompact(); }
+
+    bool isInMemory() const { return sharedData != nullptr && !sharedData->isCompact(); }
+
+    juce::int64 getLengthInSamples() const { return lengthInSamples; }
+
+    // Channels available to voices, streaming sounds keep at most a stereo pair
+    int getNumStreamChannels() const { return streamChannels; }
+
+    const juce::File &getSourceFile() const { return sourceFile; }
+
+    // Any thread: the head for the current start marker, nullptr until it has been read.
+    // A voice keeps the reference for its whole note, replaced heads are freed after it lets go
+    StreamHead::Ptr pinStreamHead() const { return streamHeads.pin(); }
+
+    // True when the start marker moved away from where the published head starts
+    bool needsStreamHead() const;
+
+    // Reads the head for the current start marker from disk and publishes it. Blocks on the
+    // file, so it runs on the importer's workers rather than the message thread
+    void primeStreamHead();
+
+    // Message thread: frees replaced heads, slice tables and host rate copies no voice holds
+    // any more, returns true while some are left
+    bool collectRetiredData();
+
+    // Reads frames straight from the file of a streaming sound, never call from the audio thread
+    bool readFromDisk(juce::AudioBuffer<float> &destination, int destStartFrame, int numFrames,
+                      juce::int64 fileStartFrame);
+
+    // Converts frames from the mapped file. Voices call it directly, a page the OS evicted
+    // since warmMappedPages faults in on the audio thread, which is why mapping is opt-in
+    void readMappedFrames(juce::int64 startFrame, int numFrames, float *const *destination, int numChannels);
+
+    // Decodes frames of a compact sound, also safe to call from the audio thread
+    void readCompactFrames(juce::int64 startFrame, int numFrames, float *const *destination, int numChannels) const;
+
+    // Reads frames of up to getNumStreamChannels() channels from wherever the sound keeps them,
+    // never call from the audio thread
+    void readAnalysisFrames(juce::int64 startFrame, int numFrames, float *const *destination, int numChannels);
+
+    // Touches every page of the mapping so the first trigger does not wait on page faults
+    void warmMappedPages() const;
+
+    // Any thread: the copy converted to sampleRate, nullptr until one has been built for that rate
+    ResampledAudio::Ptr getResampledAudio(double sampleRate) const;
+
+    // Converts the in-memory data to targetRate on the calling thread, never call from the audio thread.
+    // The sound keeps the copy for the last rate asked for, copies at other rates are freed once
+    // no sound in any instance wants them and voices playing them have finished
+    void buildResampledAudio(double targetRate);
+
+    // True once this sound holds the copy at sampleRate, getResampledAudio may also find one another instance built
+    bool holdsResampledAudio(double sampleRate) const;
+
+    // Absolute peak across all channels, including the playback gain
+    float getPeakLevel();
+
+    // Gain applied by the voice, normalisation goes through this since the data may be shared.
+    // Set on the message thread, voices read it at note start
+    float getPlaybackGain() const { return playbackGain.load(std::memory_order_relaxed); }
+
+    void setPlaybackGain(float gain) { playbackGain.store(gain, std::memory_order_relaxed); }
 
     double getSourceSampleRate() const { return sourceSampleRate; }
 
@@ -29,20 +158,36 @@ public:
 
     void setGroupIndex(int idx) { groupIndex = idx; }
 
-    float getStartMarkerPosition() const { return startMarkerPosition; }
+    float getStartMarkerPosition() const { return startMarkerPosition.load(std::memory_order_relaxed); }
 
-    float getEndMarkerPosition() const { return endMarkerPosition; }
+    float getEndMarkerPosition() const { return endMarkerPosition.load(std::memory_order_relaxed); }
 
-    void setMarkerPositions(float start, float end) {
-        startMarkerPosition = juce::jlimit(0.0f, 0.99f, start);
-        endMarkerPosition = juce::jlimit(startMarkerPosition + 0.01f, 1.0f, end);
-    }
+    void setMarkerPositions(float start, float end);
 
-    const std::vector<float> &getOnsetMarkers() const { return onsetMarkers; }
+    // Message thread, like the setters below
+    const std::vector<float> &getOnsetMarkers() const;
 
-    void setOnsetMarkers(const std::vector<float> &markers) { onsetMarkers = markers; }
+    void setOnsetMarkers(const std::vector<float> &markers);
 
-    void clearOnsetMarkers() { onsetMarkers.clear(); }
+    void clearOnsetMarkers();
+
+    // Onsets, peaks and loudness of the sample, nullptr until the analysis has finished
+    const SampleAnalysis *getAnalysis() const { return analysis.get(); }
+
+    // Message thread. Also takes the analysed onsets unless markers have been set already
+    void setAnalysis(SampleAnalysis::Ptr newAnalysis);
+
+    // Tempo grid from the analysis, invalid until it has finished or when no tempo was found.
+    // Double buffered since voices read it at note start, it only changes when an analysis arrives
+    const BeatGrid &getBeatGrid() const { return beatGrids[activeBeatGrid.load(std::memory_order_acquire)]; }
+
+    // Audio thread: the current slice table, nullptr before any markers were set. Pinned while
+    // a voice picks its slice, the UI may publish a new one meanwhile. Streaming sounds have
+    // no slices, their head only covers the start marker
+    SliceTable::Ptr pinSlices() const { return sliceTables.pin(); }
+
+    // Audio thread only: the slice sequential slice playback plays next
+    int nextSequentialSlice(int numSlices);
 
     bool isOnsetRandomizationEnabled() const { return useOnsetRandomization; }
 
@@ -50,18 +195,66 @@ public:
 
 private:
     juce::String name;
-    juce::AudioBuffer<float> audioData;
+    SharedSampleData::Ptr sharedData;
     juce::BigInteger midiNotes;
     double sourceSampleRate;
+    juce::int64 lengthInSamples = 0;
+    int streamChannels = 0;
+    std::atomic<float> playbackGain{1.0f};
+    float filePeakLevel = 0.0f;
+
+    // Holds the shared data's copy at this instance's host rate
+    ResampledAudio::Ptr hostRateCopy;
+    double hostRate = 0.0;
+    mutable juce::CriticalSection hostRateLock;
+
+    // Streaming state, re-priming publishes a new head so a playing voice keeps the one it pinned
+    bool streaming = false;
+    juce::File sourceFile; // Also set for memory-mapped and in-memory sounds
+    std::unique_ptr<juce::AudioFormatReader> diskReader;
+    juce::CriticalSection diskReaderLock;
+    SharedSnapshotPublisher<StreamHead> streamHeads;
+    juce::CriticalSection streamHeadLock; // Heads are primed on worker threads and collected on the message thread
+
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> mappedReader;
+
     int index = -1; // Sample index
     int groupIndex = -1; // Group index, -1 means no group
-    float startMarkerPosition = 0.0f;
-    float endMarkerPosition = 1.0f;
-    std::vector<float> onsetMarkers; // Onset marker positions (0.0-1.0)
-    bool useOnsetRandomization = false;
+    std::atomic<float> startMarkerPosition{0.0f};
+    std::atomic<float> endMarkerPosition{1.0f};
+    SampleAnalysis::Ptr analysis;
+    std::atomic<bool> useOnsetRandomization{false}; // Slice playback, read by voices at note start
+
+    SharedSnapshotPublisher<SliceTable> sliceTables; // Published on the message thread
+    int sequentialSlice = 0;
+
+    BeatGrid beatGrids[2];
+    std::atomic<int> activeBeatGrid{0};
+
+    // Frames read per disk access while priming, so the streamer never waits long on the reader
+    static constexpr int streamHeadReadBlockFrames = 8192;
+
+    juce::int64 getStreamHeadStartFrame() const;
+
+    void measureFilePeak(juce::AudioFormatReader &reader);
+
+    void publishSlices(const std::vector<float> &onsetMarkers);
+
+    void publishBeatGrid(const BeatGrid &grid);
+
+    juce::int64 findNearestZeroCrossing(juce::int64 frame);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SamplerSound)
 };
 
+// The only sound the synthesiser holds. It just lets notes start a voice, the voice then
+// binds the SamplerSound picked from the published sample set
+class SampleTriggerSound : public juce::SynthesiserSound {
+public:
+    bool appliesToNote(int /*midiNoteNumber*/) override { return true; }
+
+    bool appliesToChannel(int /*midiChannel*/) override { return true; }
+};
+
 
 #endif //COINCIDENCE_SAMPLERSOUND_H
@@ -0,0 +1,68 @@
+#include "SamplerSynthesiser.h"
+
+juce::SynthesiserVoice *SamplerSynthesiser::findFreeVoice(juce::SynthesiserSound *soundToPlay,
+                                                          int midiChannel,
+                                                          int midiNoteNumber,
+                                                          bool stealIfNoneAvailable) const {
+    const int usableVoices = getUsableVoiceCount();
+
+    for (int i = 0; i < usableVoices; ++i) {
+        auto *voice = voices.getUnchecked(i);
+        if (!voice->isVoiceActive() && voice->canPlaySound(soundToPlay)) {
+            return voice;
+        }
+    }
+
+    if (stealIfNoneAvailable) {
+        return findVoiceToSteal(soundToPlay, midiChannel, midiNoteNumber);
+    }
+
+    return nullptr;
+}
+
+juce::SynthesiserVoice *SamplerSynthesiser::findVoiceToSteal(juce::SynthesiserSound *soundToPlay,
+                                                             int /*midiChannel*/,
+                                                             int /*midiNoteNumber*/) const {
+    const int usableVoices = getUsableVoiceCount();
+    juce::SynthesiserVoice *bestVoice = nullptr;
+    float bestScore = std::numeric_limits<float>::max();
+
+    for (int i = 0; i < usableVoices; ++i) {
+        auto *voice = voices.getUnchecked(i);
+        if (!voice->canPlaySound(soundToPlay)) {
+            continue;
+        }
+
+        auto *samplerVoice = dynamic_cast<SamplerVoice *>(voice);
+        if (samplerVoice == nullptr) {
+            return voice;
+        }
+
+        // Quiet voices are cheap to cut, and the longer a voice has played the less its
+        // loss is noticed, so divide the level by the age in seconds
+        const double sampleRate = juce::jmax(1.0, voice->getSampleRate());
+        const double ageSeconds = static_cast<double>(samplerVoice->getSamplesPlayed()) / sampleRate;
+        float score = samplerVoice->getCurrentLevel() / static_cast<float>(1.0 + ageSeconds);
+
+        // Voices already fading out are preferred over held ones
+        if (voice->isPlayingButReleased()) {
+            score *= 0.25f;
+        }
+
+        if (score < bestScore) {
+            bestScore = score;
+            bestVoice = voice;
+        }
+    }
+
+    return bestVoice;
+}
+
+bool SamplerSynthesiser::hasActiveVoices() const {
+    for (auto *voice: voices) {
+        if (voice->isVoiceActive()) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <juce_audio_utils/juce_audio_utils.h>
+#include "SamplerVoice.h"
+
+/**
+ * Synthesiser with a fixed, preallocated pool of SamplerVoices.
+ * Only the first voiceLimit voices are handed out and stealing prefers quiet and old voices.
+ * Its sound list only ever holds a SampleTriggerSound,
+ * so loading and removing samples never takes the synthesiser's lock.
+ */
+class SamplerSynthesiser : public juce::Synthesiser {
+public:
+    static constexpr int maxVoices = 64;
+
+    SamplerSynthesiser() { addSound(new SampleTriggerSound()); }
+
+    // Thread-safe, voices above the limit finish their current note and are not reused
+    void setVoiceLimit(int newLimit) { voiceLimit = juce::jlimit(1, maxVoices, newLimit); }
+
+    [[nodiscard]] int getVoiceLimit() const { return voiceLimit; }
+
+    [[nodiscard]] bool hasActiveVoices() const;
+
+protected:
+    juce::SynthesiserVoice *findFreeVoice(juce::SynthesiserSound *soundToPlay,
+                                          int midiChannel,
+                                          int midiNoteNumber,
+                                          bool stealIfNoneAvailable) const override;
+
+    juce::SynthesiserVoice *findVoiceToSteal(juce::SynthesiserSound *soundToPlay,
+                                             int midiChannel,
+                                             int midiNoteNumber) const override;
+
+private:
+    std::atomic<int> voiceLimit{8};
+
+    [[nodiscard]] int getUsableVoiceCount() const { return std::min(voiceLimit.load(), voices.size()); }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SamplerSynthesiser)
+};
@@ -7,9 +7,21 @@
 
 SamplerVoice::SamplerVoice(SamplerVoiceState &state)
         : voiceState(state) {
+    prepare(defaultBlockSize);
     reset();
 }
 
+void SamplerVoice::prepare(int maximumBlockSize) {
+    const auto size = static_cast<size_t>(std::max(maximumBlockSize, 1));
+    positionScratch.assign(size, 0);
+    alphaScratch.assign(size, 0.0f);
+    envelopeScratch.assign(size, 0.0f);
+    interpolator.prepare(static_cast<int>(size));
+
+    // Room for a chunk at up to 4x speed, faster streaming voices render in smaller chunks
+    sourceWindow.setSize(2, static_cast<int>(size) * 4 + Interpolator::maxTapsBefore + Interpolator::maxTapsAfter + 2);
+}
+
 void SamplerVoice::reset() {
     playing = false;
     currentSampleIndex = -1;
@@ -17,10 +29,41 @@ void SamplerVoice::reset() {
     pitchRatio = 1.0;
     lgain = 0.0f;
     rgain = 0.0f;
+    samplesPlayed = 0;
+    releasing = false;
+    releaseGain = 1.0f;
+    releaseStep = 0.0f;
+    playingSlice = false;
+    pendingBeatSync = false;
+
+    // The streamer must be asked to let go of the sound before the reference is dropped
+    stopStream();
+    boundSound = nullptr;
+    playbackData = nullptr;
+    resampledAudio = nullptr;
+}
+
+void SamplerVoice::stopStream() {
+    if (streamActive && stream != nullptr) {
+        stream->stop();
+    }
+
+    streamActive = false;
+    streamHead = nullptr;
+}
+
+void SamplerVoice::endNote() {
+    clearCurrentNote();
+    playing = false;
+    stopStream();
+
+    // An idle voice must not keep a removed sample or an old host rate copy alive
+    boundSound = nullptr;
+    resampledAudio = nullptr;
 }
 
 bool SamplerVoice::canPlaySound(juce::SynthesiserSound *sound) {
-    return dynamic_cast<SamplerSound *>(sound);
+    return dynamic_cast<SampleTriggerSound *>(sound) != nullptr;
 }
 
 void SamplerVoice::renderNextBlock(juce::AudioBuffer<float> &outputBuffer,
@@ -30,50 +73,229 @@ void SamplerVoice::renderNextBlock(juce::AudioBuffer<float> &outputBuffer,
         return;
     }
 
-    auto *soundToUse = voiceState.getCurrentSound();
-    if (soundToUse == nullptr) {
+    if (boundSound == nullptr) {
         return;
     }
 
-    auto &data = *soundToUse->getAudioData();
-    const int numChannels = data.getNumChannels();
+    if (pendingBeatSync) {
+        alignToHostBeat(startSample);
+    }
+
+    const bool streaming = boundSound->isStreaming();
+    const bool windowed = !boundSound->isInMemory();
+    const auto &data = *playbackData;
+    const int numChannels = std::min(windowed ? boundSound->getNumStreamChannels() : data.getNumChannels(),
+                                     outputBuffer.getNumChannels());
     const int numSourceSamples = data.getNumSamples();
+    const int blockCapacity = static_cast<int>(positionScratch.size());
 
-    juce::AudioBuffer<float> tempBuffer;
-    tempBuffer.setSize(outputBuffer.getNumChannels(), numSamples);
-    tempBuffer.clear();
+    interpolator.setMode(voiceState.getInterpolationMode());
+    interpolator.setPlaybackRatio(pitchRatio);
 
-    for (int sampleIndex = 0; sampleIndex < numSamples; ++sampleIndex) {
-        const int sourcePos = static_cast<int>(sourceSamplePosition);
+    // Hosts may exceed the block size announced in prepareToPlay, so render in chunks
+    int framesRendered = 0;
+    while (playing && framesRendered < numSamples) {
+        int chunkSize = std::min(numSamples - framesRendered, blockCapacity);
+        int readableSamples = numSourceSamples;
 
-        if (sourcePos >= numSourceSamples - 1 || sourcePos >= sourceEndPosition || sourcePos < 0) {
-            clearCurrentNote();
-            playing = false;
-            break;
+        if (windowed) {
+            chunkSize = std::min(chunkSize, windowChunkLimit);
+            readableSamples = streaming ? getStreamReadableSamples()
+                                        : static_cast<int>(boundSound->getLengthInSamples());
         }
 
-        auto alpha = static_cast<float>(sourceSamplePosition - sourcePos);
+        int framesToRender = computeBlockPositions(chunkSize, readableSamples);
+
+        const float *envelope = nullptr;
+        if (releasing) {
+            framesToRender = computeReleaseEnvelope(framesToRender);
+            envelope = envelopeScratch.data();
+        }
+
+        if (playingSlice && framesToRender > 0) {
+            applySliceRamps(framesToRender, envelope != nullptr);
+            envelope = envelopeScratch.data();
+        }
 
-        const int minChannels = std::min(numChannels, tempBuffer.getNumChannels());
-        for (int channel = 0; channel < minChannels; ++channel) {
-            const float *const inBuffer = data.getReadPointer(channel);
-            float *const outBuffer = tempBuffer.getWritePointer(channel, sampleIndex);
+        const int windowSize = (windowed && framesToRender > 0)
+                               ? fillSourceWindow(framesToRender, numChannels)
+                               : numSourceSamples;
 
-            // linear interpolation for pitch shifting
-            float sample1 = inBuffer[sourcePos];
-            float sample2 = inBuffer[sourcePos + 1];
-            float interpolatedSample = sample1 + alpha * (sample2 - sample1);
+        // Whole-sample positions at unity ratio have nothing to interpolate
+        const bool straightCopy = !windowed && pitchRatio == 1.0 && framesToRender > 0 && alphaScratch[0] == 0.0f;
 
+        for (int channel = 0; channel < numChannels && framesToRender > 0; ++channel) {
             const float gain = (channel == 0) ? lgain : rgain;
-            *outBuffer = interpolatedSample * gain;
+            if (straightCopy) {
+                interpolator.copy(data.getReadPointer(channel, positionScratch[0]),
+                                  outputBuffer.getWritePointer(channel, startSample + framesRendered),
+                                  gain,
+                                  envelope,
+                                  framesToRender);
+                continue;
+            }
+
+            interpolator.process(windowed ? sourceWindow.getReadPointer(channel) : data.getReadPointer(channel),
+                                 windowSize,
+                                 positionScratch.data(),
+                                 alphaScratch.data(),
+                                 outputBuffer.getWritePointer(channel, startSample + framesRendered),
+                                 gain,
+                                 envelope,
+                                 framesToRender);
+        }
+
+        if (streamActive) {
+            stream->discardBefore(static_cast<juce::int64>(sourceSamplePosition) - Interpolator::maxTapsBefore);
+        }
+
+        framesRendered += framesToRender;
+        samplesPlayed += framesToRender;
+
+        if (framesToRender < chunkSize) {
+            endNote();
+        }
+    }
+}
+
+int SamplerVoice::getStreamReadableSamples() {
+    const juce::int64 length = boundSound->getLengthInSamples();
+    juce::int64 availableEnd = streamHead->getEndFrame();
+
+    // The ring continues exactly where the head ends
+    if (streamActive && stream->isReady()) {
+        availableEnd = std::max(availableEnd, stream->getFirstBufferedFrame() + stream->getNumBufferedFrames());
+    }
+
+    const juce::int64 readableEnd = availableEnd >= length ? length : availableEnd - Interpolator::maxTapsAfter;
+    const bool coversNote = readableEnd >= length || static_cast<double>(readableEnd) > sourceEndPosition + 1.0;
+
+    if (!coversNote && !releasing) {
+        // Source frames consumed by the next chunk plus a full release ramp
+        const double reserve = (releaseTimeSeconds * getSampleRate() + static_cast<double>(positionScratch.size()))
+                               * pitchRatio + Interpolator::maxTapsAfter + 1.0;
+
+        if (static_cast<double>(readableEnd) - sourceSamplePosition < reserve) {
+            beginRelease();
+            if (stream != nullptr) {
+                stream->reportUnderrun();
+            }
+        }
+    }
+
+    return static_cast<int>(readableEnd);
+}
+
+int SamplerVoice::fillSourceWindow(int numFrames, int numChannels) {
+    const juce::int64 firstAvailable = streamHead != nullptr ? streamHead->startFrame : 0;
+    const juce::int64 windowStart = std::max<juce::int64>(firstAvailable,
+                                                          positionScratch[0] - Interpolator::maxTapsBefore);
+    const juce::int64 windowEnd = std::min<juce::int64>(boundSound->getLengthInSamples(),
+                                                        positionScratch[static_cast<size_t>(numFrames - 1)]
+                                                        + Interpolator::maxTapsAfter + 1);
+    const int windowSize = static_cast<int>(windowEnd - windowStart);
+
+    for (int frame = 0; frame < numFrames; ++frame) {
+        positionScratch[static_cast<size_t>(frame)] -= static_cast<int>(windowStart);
+    }
+
+    if (boundSound->isMemoryMapped()) {
+        boundSound->readMappedFrames(windowStart, windowSize, sourceWindow.getArrayOfWritePointers(), numChannels);
+        return windowSize;
+    }
+
+    if (boundSound->isCompact()) {
+        boundSound->readCompactFrames(windowStart, windowSize, sourceWindow.getArrayOfWritePointers(), numChannels);
+        return windowSize;
+    }
+
+    const auto &head = *streamHead;
+    const int fromHead = static_cast<int>(juce::jlimit<juce::int64>(0, windowSize, head.getEndFrame() - windowStart));
+
+    for (int channel = 0; channel < numChannels; ++channel) {
+        float *window = sourceWindow.getWritePointer(channel);
+
+        if (fromHead > 0) {
+            juce::FloatVectorOperations::copy(window,
+                                              head.frames.getReadPointer(channel)
+                                              + static_cast<int>(windowStart - head.startFrame),
+                                              fromHead);
+        }
+
+        if (fromHead < windowSize) {
+            stream->copyFrames(windowStart + fromHead, windowSize - fromHead, channel, window + fromHead);
+        }
+    }
+
+    return windowSize;
+}
+
+int SamplerVoice::computeBlockPositions(int numFrames, int numSourceSamples) {
+    // The last readable position needs a following sample to interpolate against
+    const double lastPosition = std::min(static_cast<double>(numSourceSamples - 1), sourceEndPosition);
+
+    int frame = 0;
+    for (; frame < numFrames; ++frame) {
+        const int sourcePos = static_cast<int>(sourceSamplePosition);
+
+        if (sourcePos < 0 || sourcePos >= lastPosition) {
+            break;
         }
 
+        positionScratch[frame] = sourcePos;
+        alphaScratch[frame] = static_cast<float>(sourceSamplePosition - sourcePos);
         sourceSamplePosition += pitchRatio;
     }
 
-    for (int channel = 0; channel < outputBuffer.getNumChannels(); ++channel) {
-        outputBuffer.addFrom(channel, startSample, tempBuffer, channel, 0, numSamples);
+    return frame;
+}
+
+void SamplerVoice::applySliceRamps(int numFrames, bool hasEnvelope) {
+    // Positions are still absolute here, the window rebase happens after the envelope
+    const double rampScale = 1.0 / sliceRampLength;
+
+    for (int frame = 0; frame < numFrames; ++frame) {
+        const double position = positionScratch[frame] + static_cast<double>(alphaScratch[frame]);
+        const double fade = std::min((position - sliceStartPosition) * rampScale,
+                                     (sourceEndPosition - position) * rampScale);
+        const auto gain = static_cast<float>(juce::jlimit(0.0, 1.0, fade));
+
+        envelopeScratch[frame] = hasEnvelope ? envelopeScratch[frame] * gain : gain;
+    }
+}
+
+void SamplerVoice::alignToHostBeat(int startSample) {
+    pendingBeatSync = false;
+
+    // Whole host bars of the loop between its first beat and the end marker, a beat being
+    // a quarter note like the host's ppq
+    const double beatsPerBar = voiceState.getHostQuartersPerBar();
+    const double barFrames = syncFramesPerBeat * beatsPerBar;
+    const double loopBars = std::floor((sourceEndPosition - syncFirstBeat) / barFrames);
+    if (loopBars < 1.0) {
+        return;
+    }
+
+    // Longer loops follow the host across their bars, not only within one. Counting from the
+    // host's bar start keeps them on the bar after a time signature change
+    const double loopBeats = loopBars * beatsPerBar;
+    double beat = std::fmod(voiceState.getPpqAt(startSample, getSampleRate()) - voiceState.getHostBarStartPpq(),
+                            loopBeats);
+    if (beat < 0.0) {
+        beat += loopBeats;
+    }
+
+    sourceSamplePosition = syncFirstBeat + beat * syncFramesPerBeat;
+}
+
+int SamplerVoice::computeReleaseEnvelope(int numFrames) {
+    int frame = 0;
+    for (; frame < numFrames && releaseGain > 0.0f; ++frame) {
+        envelopeScratch[frame] = releaseGain;
+        releaseGain -= releaseStep;
     }
+
+    return frame;
 }
 
 void SamplerVoice::startNote(int midiNoteNumber,
@@ -82,7 +304,15 @@ void SamplerVoice::startNote(int midiNoteNumber,
                              int /*pitchWheelPosition*/) {
     reset();
 
-    if (auto *samplerSound = dynamic_cast<SamplerSound *>(sound)) {
+    // The synthesiser only hands us its trigger sound. The sample picked by the note generator
+    // is bound for the rest of the note, the reader keeps it alive until we hold a reference.
+    auto sampleSet = voiceState.readSampleSet();
+    const int sampleIndex = voiceState.getCurrentSampleIndex();
+    auto *samplerSound = dynamic_cast<SampleTriggerSound *>(sound) != nullptr && sampleSet
+                         ? sampleSet->getSound(sampleIndex)
+                         : nullptr;
+
+    if (samplerSound != nullptr) {
         double midiNoteHz = juce::MidiMessage::getMidiNoteInHertz(midiNoteNumber);
         double soundMidiNoteHz = juce::MidiMessage::getMidiNoteInHertz(60);
 
@@ -92,32 +322,139 @@ void SamplerVoice::startNote(int midiNoteNumber,
             pitchRatio = 1.0;
         }
 
-        double ratio = pitchRatio * getSampleRate()
-                       / samplerSound->getSourceSampleRate();
+        // In-memory sounds may carry a copy already converted to the host rate
+        playbackData = samplerSound->getAudioData();
+        double dataSampleRate = samplerSound->getSourceSampleRate();
+
+        if (voiceState.isResampledPlaybackEnabled() && samplerSound->isInMemory()) {
+            resampledAudio = samplerSound->getResampledAudio(getSampleRate());
+            if (resampledAudio != nullptr) {
+                playbackData = &resampledAudio->frames;
+                dataSampleRate = resampledAudio->sampleRate;
+            }
+        }
 
-        int numSamples = samplerSound->getAudioData()->getNumSamples();
+        double ratio = pitchRatio * getSampleRate() / dataSampleRate;
+
+        const auto numSamples = samplerSound->isInMemory() ? static_cast<juce::int64>(playbackData->getNumSamples())
+                                                           : samplerSound->getLengthInSamples();
         float startMarker = samplerSound->getStartMarkerPosition();
         float endMarker = samplerSound->getEndMarkerPosition();
 
         sourceSamplePosition = static_cast<double>(numSamples) * startMarker;
         sourceEndPosition = static_cast<double>(numSamples) * endMarker;
         pitchRatio = ratio;
-        lgain = velocity;
-        rgain = velocity;
+
+        // Slice playback takes one stretch between onsets from the precomputed table instead
+        playingSlice = false;
+        if (samplerSound->isOnsetRandomizationEnabled() && !samplerSound->isStreaming()) {
+            const auto sliceTable = samplerSound->pinSlices();
+            if (sliceTable != nullptr && !sliceTable->slices.empty()) {
+                const auto &slices = sliceTable->slices;
+                const auto &slice = slices[static_cast<size_t>(
+                        voiceState.pickSlice(*samplerSound, static_cast<int>(slices.size())))];
+
+                // Slices are in source frames, a host rate copy is a little longer or shorter
+                const double frameScale = static_cast<double>(numSamples)
+                                          / static_cast<double>(samplerSound->getLengthInSamples());
+                sourceSamplePosition = static_cast<double>(slice.startFrame) * frameScale;
+                sourceEndPosition = static_cast<double>(slice.endFrame) * frameScale;
+                sliceStartPosition = sourceSamplePosition;
+                sliceRampLength = std::max(1.0, slice.rampFrames * frameScale);
+                playingSlice = true;
+            }
+        }
+
+        // Loops with a tempo play in time with the host. Streaming sounds only hold the head
+        // from the start marker, so they keep playing from there
+        const auto &beatGrid = samplerSound->getBeatGrid();
+        if (!playingSlice && !samplerSound->isStreaming() && voiceState.isBeatSyncEnabled()
+            && voiceState.getHostBpm() > 0.0 && beatGrid.isValid()) {
+            // Onsets alone cannot tell half or double time apart, so take the reading of the loop's
+            // tempo nearest the host's rather than playing it at twice or half the speed
+            const double hostBpm = voiceState.getHostBpm();
+            const double loopBpm = beatGrid.bpm * std::exp2(std::round(std::log2(hostBpm / beatGrid.bpm)));
+            pitchRatio *= hostBpm / loopBpm;
+
+            const double frameScale = static_cast<double>(numSamples)
+                                      / static_cast<double>(samplerSound->getLengthInSamples());
+            syncFramesPerBeat = 60.0 * samplerSound->getSourceSampleRate() / loopBpm * frameScale;
+            syncFirstBeat = beatGrid.firstBeatFrame * frameScale;
+
+            // The first beat at or after the start marker
+            if (syncFirstBeat < sourceSamplePosition) {
+                syncFirstBeat += std::ceil((sourceSamplePosition - syncFirstBeat) / syncFramesPerBeat)
+                                 * syncFramesPerBeat;
+            }
+            pendingBeatSync = true;
+        }
+
+        // Starting on a whole sample lets unity-ratio notes render as a plain copy
+        if (pitchRatio == 1.0 && samplerSound->isInMemory()) {
+            sourceSamplePosition = std::floor(sourceSamplePosition);
+        }
+        const float gain = velocity * samplerSound->getPlaybackGain();
+        lgain = gain;
+        rgain = gain;
+
+        if (samplerSound->isStreaming()) {
+            streamHead = samplerSound->pinStreamHead();
+
+            // The head was primed from the start marker, anything else means it is being re-primed
+            if (streamHead == nullptr
+                || sourceSamplePosition < static_cast<double>(streamHead->startFrame)
+                || sourceSamplePosition >= static_cast<double>(streamHead->getEndFrame())) {
+                streamHead = nullptr;
+                return;
+            }
+
+            if (stream != nullptr && streamHead->getEndFrame() < samplerSound->getLengthInSamples()) {
+                stream->start(samplerSound, streamHead->getEndFrame());
+                streamActive = true;
+            }
+        }
+
+        if (!samplerSound->isInMemory()) {
+            const int windowMargin = Interpolator::maxTapsBefore + Interpolator::maxTapsAfter + 2;
+            windowChunkLimit = std::max(1, static_cast<int>((sourceWindow.getNumSamples() - windowMargin)
+                                                            / std::max(1.0, pitchRatio)));
+        }
+
+        boundSound = samplerSound;
+        currentSampleIndex = sampleIndex;
         playing = true;
     }
 }
 
 void SamplerVoice::stopNote(float /*velocity*/, bool allowTailOff) {
-    clearCurrentNote();
-    playing = false;
+    if (allowTailOff && playing) {
+        beginRelease();
+        return;
+    }
+
+    endNote();
     reset();
 }
 
+void SamplerVoice::beginRelease() {
+    if (!releasing) {
+        releasing = true;
+        releaseStep = static_cast<float>(1.0 / std::max(1.0, releaseTimeSeconds * getSampleRate()));
+    }
+}
+
 void SamplerVoice::pitchWheelMoved(int newPitchWheelValue) {}
 
 void SamplerVoice::controllerMoved(int controllerNumber, int newControllerValue) {}
 
 bool SamplerVoice::isVoiceActive() const {
     return playing && getCurrentlyPlayingSound() != nullptr;
+}
+
+float SamplerVoice::getCurrentLevel() const {
+    if (!playing) {
+        return 0.0f;
+    }
+
+    return std::max(lgain, rgain) * (releasing ? std::max(releaseGain, 0.0f) : 1.0f);
 }
\ No newline at end of file
@@ -6,7 +6,10 @@
 #define COINCIDENCE_SAMPLERVOICE_H
 
 #include <juce_audio_utils/juce_audio_utils.h>
+#include <vector>
 #include "SamplerVoiceState.h"
+#include "Interpolator.h"
+#include "SampleStreamer.h"
 
 class SamplerVoice : public juce::SynthesiserVoice {
 public:
@@ -31,18 +34,104 @@ public:
 
     void reset();
 
+    // Sizes the per-block scratch buffers, must not be called from the audio thread
+    void prepare(int maximumBlockSize);
+
+    // Disk stream used when this voice plays a streaming sound
+    void setStream(SampleStream *newStream) { stream = newStream; }
+
     [[nodiscard]] bool isVoiceActive() const override;
 
+    // Current output gain including the release ramp, used to rank voices for stealing
+    [[nodiscard]] float getCurrentLevel() const;
+
+    [[nodiscard]] juce::int64 getSamplesPlayed() const { return samplesPlayed; }
+
+    // Index of the sample this voice bound at startNote, -1 while idle
+    [[nodiscard]] int getBoundSampleIndex() const { return currentSampleIndex; }
+
 private:
+    static constexpr int defaultBlockSize = 512;
+    static constexpr double releaseTimeSeconds = 0.03;
+
     double pitchRatio = 1.0;
     double sourceSamplePosition = 0.0;
     double sourceEndPosition = 0.0;
     float lgain = 0.0f, rgain = 0.0f;
     bool playing = false;
     int currentSampleIndex = -1;
+    juce::int64 samplesPlayed = 0;
+
+    // Short linear release so a note-off or retrigger fades instead of hard-cutting
+    bool releasing = false;
+    float releaseGain = 1.0f;
+    float releaseStep = 0.0f;
+
+    // Slice playback fades in from the slice start and out towards sourceEndPosition
+    bool playingSlice = false;
+    double sliceStartPosition = 0.0;
+    double sliceRampLength = 1.0;
+
+    // Beat-synced loops pick their start once the first render tells us where the note fell in
+    // the block. Both are in frames of playbackData
+    bool pendingBeatSync = false;
+    double syncFirstBeat = 0.0;
+    double syncFramesPerBeat = 0.0;
+
+    // The sound this voice was started with. The reference keeps a removed sample playable
+    // until the note ends, SampleManager frees it afterwards on the message thread
+    SamplerSound::Ptr boundSound;
+
+    // In-memory frames the note plays, the sound's own data or its copy at the host rate.
+    // The copy is pinned for the whole note
+    const juce::AudioBuffer<float> *playbackData = nullptr;
+    SharedSampleData::ResampledAudio::Ptr resampledAudio;
 
     SamplerVoiceState &voiceState;
 
+    // Streaming playback reads the in-memory head first and then the disk ring
+    SampleStream *stream = nullptr;
+    SamplerSound::StreamHead::Ptr streamHead; // Pinned for the whole note
+    bool streamActive = false;
+
+    // Sounds that are not held in memory are gathered into this window chunk by chunk
+    int windowChunkLimit = 0;
+    juce::AudioBuffer<float> sourceWindow;
+
+    // Per-block scratch, sized in prepare() so rendering never allocates
+    std::vector<int> positionScratch;
+    std::vector<float> alphaScratch;
+    std::vector<float> envelopeScratch;
+
+    Interpolator interpolator;
+
+    // Precomputes integer source positions and interpolation fractions for up to numFrames
+    // output frames, returns how many can be rendered before the voice runs out of source
+    int computeBlockPositions(int numFrames, int numSourceSamples);
+
+    // Fills the release ramp for up to numFrames frames, returns how many are still audible
+    int computeReleaseEnvelope(int numFrames);
+
+    void beginRelease();
+
+    // Multiplies the slice's declick ramps into the envelope, or writes them if there is none yet
+    void applySliceRamps(int numFrames, bool hasEnvelope);
+
+    // Moves the start to the beat of the loop matching the host's position in its bar
+    void alignToHostBeat(int startSample);
+
+    void stopStream();
+
+    // End of the source range a streaming voice can read right now. Starts the release early
+    // when the disk falls behind so the fade still has buffered audio to play
+    int getStreamReadableSamples();
+
+    // Gathers the source frames a chunk needs into sourceWindow, from the stream or the
+    // mapped file, and rebases the chunk's positions onto the window
+    int fillSourceWindow(int numFrames, int numChannels);
+
+    void endNote();
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SamplerVoice)
 };
 
@@ -7,29 +7,106 @@
 
 #include <juce_audio_utils/juce_audio_utils.h>
 #include "SamplerSound.h"
+#include "SampleSet.h"
+#include "../../Shared/Models.h"
+#include "../Util/SnapshotPublisher.h"
+#include "../../Shared/RandomService.h"
 
 class SamplerVoiceState {
 public:
     SamplerVoiceState() : currentSampleIndex(-1), pitchFollowEnabled(false) {}
 
+    // The sample the next voice to start binds, audio thread only
     void setCurrentSampleIndex(int sampleIndex) { currentSampleIndex = sampleIndex; }
 
     [[nodiscard]] int getCurrentSampleIndex() const { return currentSampleIndex; }
 
-    void registerSoundWithIndex(SamplerSound *sound, int index);
+    using SampleSetReader = SnapshotPublisher<SampleSet>::Reader;
 
-    SamplerSound *getCurrentSound();
+    // Message thread: swaps in the sample set the audio thread picks and plays samples from
+    void publishSampleSet(std::unique_ptr<SampleSet> sampleSet) { sampleSets.publish(std::move(sampleSet)); }
 
-    void clearSoundRegistrations() { indexToSoundMap.clear(); }
+    // Message thread: frees replaced sample sets the audio thread has let go of
+    void collectRetiredSampleSets() { sampleSets.collectGarbage(); }
+
+    // Audio thread: pins the current sample set, a reader spanning a whole block keeps
+    // note selection and voice starts on the same set
+    SampleSetReader readSampleSet() { return SampleSetReader(sampleSets); }
+
+    // Slice playback steps through a sound's slices in order, or picks them from this stream
+    void setRandomSliceOrder(bool isRandom) { randomSliceOrder = isRandom; }
+
+    void setSliceRandomStream(RandomStream *stream) { sliceRandom = stream; }
+
+    // Audio thread: the slice of sound a starting voice plays, numSlices must be positive
+    int pickSlice(SamplerSound &sound, int numSlices) {
+        if (randomSliceOrder && sliceRandom != nullptr) {
+            return sliceRandom->nextInt(numSlices);
+        }
+        return sound.nextSequentialSlice(numSlices);
+    }
 
     [[nodiscard]] bool isPitchFollowEnabled() const { return pitchFollowEnabled; }
 
     void setPitchFollowEnabled(bool enabled) { pitchFollowEnabled = enabled; }
 
+    // Voices prefer a sound's copy at the host rate when one has been built
+    void setResampledPlaybackEnabled(bool enabled) { resampledPlayback = enabled; }
+
+    [[nodiscard]] bool isResampledPlaybackEnabled() const { return resampledPlayback; }
+
+    void setRealtimeInterpolationMode(Models::InterpolationMode mode) { realtimeInterpolation = mode; }
+
+    void setOfflineInterpolationMode(Models::InterpolationMode mode) { offlineInterpolation = mode; }
+
+    // Offline renders (bounces) use their own, usually more expensive, interpolation mode
+    void setRenderingOffline(bool isOffline) { renderingOffline = isOffline; }
+
+    [[nodiscard]] Models::InterpolationMode getInterpolationMode() const {
+        return renderingOffline ? offlineInterpolation.load() : realtimeInterpolation.load();
+    }
+
+    // Loops with a beat grid start on the host's bar position, repitched to the host tempo
+    void setBeatSyncEnabled(bool enabled) { beatSync = enabled; }
+
+    [[nodiscard]] bool isBeatSyncEnabled() const { return beatSync; }
+
+    // Audio thread: host tempo, position at the start of the block being rendered, and where
+    // and how long the current bar is, in quarter notes
+    void setHostTiming(double bpm, double ppqAtBlockStart, double barStartPpq, double quartersPerBar) {
+        hostBpm = bpm;
+        blockPpq = ppqAtBlockStart;
+        hostBarStartPpq = barStartPpq;
+        hostQuartersPerBar = quartersPerBar;
+    }
+
+    [[nodiscard]] double getHostBpm() const { return hostBpm; }
+
+    [[nodiscard]] double getHostBarStartPpq() const { return hostBarStartPpq; }
+
+    [[nodiscard]] double getHostQuartersPerBar() const { return hostQuartersPerBar; }
+
+    // Host position offset output frames into the block
+    [[nodiscard]] double getPpqAt(int offset, double sampleRate) const {
+        return blockPpq + offset * hostBpm / (60.0 * sampleRate);
+    }
+
 private:
     int currentSampleIndex;
-    std::map<int, SamplerSound *> indexToSoundMap;
+    SnapshotPublisher<SampleSet> sampleSets;
     bool pitchFollowEnabled;
+
+    std::atomic<Models::InterpolationMode> realtimeInterpolation{Models::INTERPOLATION_LINEAR};
+    std::atomic<Models::InterpolationMode> offlineInterpolation{Models::INTERPOLATION_SINC};
+    std::atomic<bool> renderingOffline{false};
+    std::atomic<bool> resampledPlayback{true};
+    std::atomic<bool> randomSliceOrder{true};
+    std::atomic<bool> beatSync{false};
+    double hostBpm = 0.0;
+    double blockPpq = 0.0;
+    double hostBarStartPpq = 0.0;
+    double hostQuartersPerBar = 4.0;
+    RandomStream *sliceRandom = nullptr;
 };
 
 
@@ -0,0 +1,167 @@
+#include "TempoEstimator.h"
+
+namespace {
+    // Frames either side of each frame in the local mean of the onset envelope
+    constexpr int meanRadius = 8;
+
+    // Tempo prior, a log-normal around 120 BPM one octave wide
+    constexpr double priorCentreBpm = 120.0;
+    constexpr double priorOctaves = 1.0;
+
+    // A tempo within this fraction of one fitting the sample exactly is snapped to it
+    constexpr double loopSnapTolerance = 0.02;
+
+    // Multiples of each lag summed into its score
+    constexpr int numHarmonics = 4;
+}
+
+BeatGrid TempoEstimator::estimate(const std::vector<float> &detectionFunction, int frameSize, int hopSize,
+                                  double sampleRate, juce::int64 numSourceFrames) {
+    BeatGrid grid;
+
+    const double framesPerSecond = sampleRate / hopSize;
+    const int numFrames = static_cast<int>(detectionFunction.size());
+    if (sampleRate <= 0.0 || numFrames < framesPerSecond * minimumSeconds) {
+        return grid;
+    }
+
+    const auto envelope = computeOnsetEnvelope(detectionFunction);
+
+    const int minLag = juce::jmax(1, static_cast<int>(std::floor(60.0 * framesPerSecond / maxBpm)));
+    const int maxLag = juce::jmin(numFrames / 2, static_cast<int>(std::ceil(60.0 * framesPerSecond / minBpm)));
+    if (maxLag <= minLag + 1) {
+        return grid;
+    }
+
+    // Autocorrelation up to a few periods of the longest lag, each lag also hears its multiples
+    const int numLags = juce::jmin(numFrames - 1, numHarmonics * maxLag + 1);
+    std::vector<double> autocorrelation(static_cast<size_t>(numLags + 1), 0.0);
+    for (int lag = 0; lag <= numLags; ++lag) {
+        double sum = 0.0;
+        for (int t = 0; t + lag < numFrames; ++t) {
+            sum += static_cast<double>(envelope[static_cast<size_t>(t)]) * envelope[static_cast<size_t>(t + lag)];
+        }
+        autocorrelation[static_cast<size_t>(lag)] = sum / (numFrames - lag);
+    }
+
+    if (autocorrelation[0] <= 0.0) {
+        return grid;
+    }
+
+    std::vector<double> scores(static_cast<size_t>(maxLag + 2), 0.0);
+    int bestLag = minLag;
+    for (int lag = minLag; lag <= maxLag; ++lag) {
+        const double bpm = 60.0 * framesPerSecond / lag;
+        const double octaves = std::log2(bpm / priorCentreBpm) / priorOctaves;
+        const double prior = std::exp(-0.5 * octaves * octaves);
+
+        // Averaging over multiples of the lag keeps a loop that repeats every two beats from
+        // reading as half its tempo, the shorter lag also collects the longer one's peak
+        double score = 0.0;
+        int numTerms = 0;
+        for (int harmonic = 1; harmonic <= numHarmonics && harmonic * lag <= numLags; ++harmonic) {
+            score += autocorrelation[static_cast<size_t>(harmonic * lag)];
+            ++numTerms;
+        }
+        scores[static_cast<size_t>(lag)] = score / numTerms * prior;
+
+        if (scores[static_cast<size_t>(lag)] > scores[static_cast<size_t>(bestLag)]) {
+            bestLag = lag;
+        }
+    }
+
+    // Parabolic interpolation between the neighbouring lags for a fractional period
+    double period = bestLag;
+    if (bestLag > minLag && bestLag < maxLag) {
+        const double before = scores[static_cast<size_t>(bestLag - 1)];
+        const double at = scores[static_cast<size_t>(bestLag)];
+        const double after = scores[static_cast<size_t>(bestLag + 1)];
+        const double curvature = before - 2.0 * at + after;
+        if (curvature < 0.0) {
+            period += 0.5 * (before - after) / curvature;
+        }
+    }
+
+    grid.confidence = static_cast<float>(juce::jlimit(0.0, 1.0, autocorrelation[static_cast<size_t>(bestLag)]
+                                                                  / autocorrelation[0]));
+    if (grid.confidence < minimumConfidence) {
+        return {};
+    }
+
+    grid.bpm = 60.0 * framesPerSecond / period;
+
+    // Loops are usually cut to a whole number of beats, which pins the tempo down far more
+    // precisely than the hop does
+    const double seconds = static_cast<double>(numSourceFrames) / sampleRate;
+    const double beats = std::round(seconds * grid.bpm / 60.0);
+    if (beats >= BeatGrid::beatsPerBar) {
+        const double loopBpm = 60.0 * beats / seconds;
+        if (std::abs(loopBpm - grid.bpm) <= grid.bpm * loopSnapTolerance) {
+            grid.bpm = loopBpm;
+        }
+    }
+
+    // A frame's flux peaks once the onset is about half a frame into it, so the beat sits that
+    // much later than the frame's start. Wrapped back into the first beat
+    const double beatPeriod = 60.0 * framesPerSecond / grid.bpm;
+    const double beatFrames = beatPeriod * hopSize;
+    grid.firstBeatFrame = std::fmod(findBeatPhase(envelope, beatPeriod) * hopSize + frameSize / 2, beatFrames);
+    if (beatFrames - grid.firstBeatFrame < hopSize) {
+        grid.firstBeatFrame = 0.0;
+    }
+    return grid;
+}
+
+std::vector<float> TempoEstimator::computeOnsetEnvelope(const std::vector<float> &detectionFunction) {
+    const int size = static_cast<int>(detectionFunction.size());
+    std::vector<float> envelope(detectionFunction.size(), 0.0f);
+
+    double windowSum = 0.0;
+    int windowStart = 0, windowEnd = 0;
+    float peak = 0.0f;
+
+    for (int i = 0; i < size; ++i) {
+        for (const int end = std::min(size, i + meanRadius + 1); windowEnd < end; ++windowEnd) {
+            windowSum += detectionFunction[static_cast<size_t>(windowEnd)];
+        }
+        for (const int start = std::max(0, i - meanRadius); windowStart < start; ++windowStart) {
+            windowSum -= detectionFunction[static_cast<size_t>(windowStart)];
+        }
+
+        const auto mean = static_cast<float>(windowSum / (windowEnd - windowStart));
+        envelope[static_cast<size_t>(i)] = juce::jmax(0.0f, detectionFunction[static_cast<size_t>(i)] - mean);
+        peak = juce::jmax(peak, envelope[static_cast<size_t>(i)]);
+    }
+
+    if (peak > 0.0f) {
+        juce::FloatVectorOperations::multiply(envelope.data(), 1.0f / peak, size);
+    }
+
+    return envelope;
+}
+
+double TempoEstimator::findBeatPhase(const std::vector<float> &envelope, double beatPeriod) {
+    const auto size = static_cast<double>(envelope.size());
+    double bestPhase = 0.0, bestSum = -1.0;
+
+    // Linear interpolation keeps the comb on fractional beat positions over long samples
+    auto sample = [&envelope](double position) {
+        const auto index = static_cast<size_t>(position);
+        const auto fraction = static_cast<float>(position - static_cast<double>(index));
+        const float next = index + 1 < envelope.size() ? envelope[index + 1] : 0.0f;
+        return envelope[index] + (next - envelope[index]) * fraction;
+    };
+
+    for (double phase = 0.0; phase < beatPeriod; phase += 1.0) {
+        double sum = 0.0;
+        for (double position = phase; position < size; position += beatPeriod) {
+            sum += sample(position);
+        }
+        if (sum > bestSum) {
+            bestSum = sum;
+            bestPhase = phase;
+        }
+    }
+
+    return bestPhase;
+}
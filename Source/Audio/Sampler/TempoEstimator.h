@@ -0,0 +1,34 @@
+#pragma once
+
+#include <juce_audio_utils/juce_audio_utils.h>
+#include <vector>
+#include "SampleAnalysis.h"
+
+/**
+ * Estimates the tempo and beat grid of a loop from the spectral flux onset detection
+ * already computed, so no second spectral pass is needed. The tempo comes from the
+ * autocorrelation of the onset envelope weighted towards moderate tempos, the grid's
+ * phase from a comb of beats slid across the envelope.
+ */
+class TempoEstimator {
+public:
+    static constexpr double minBpm = 60.0;
+    static constexpr double maxBpm = 200.0;
+    static constexpr double minimumSeconds = 2.0;
+    static constexpr float minimumConfidence = 0.1f;
+
+    /**
+     * @param detectionFunction Flux of consecutive frames of frameSize source frames, hopSize apart
+     * @param sampleRate Source rate the hop is counted in
+     * @param numSourceFrames Length of the sample, a tempo fitting it a whole number of beats is preferred
+     * @return An invalid grid if the sample is too short or has no steady pulse
+     */
+    static BeatGrid estimate(const std::vector<float> &detectionFunction, int frameSize, int hopSize,
+                             double sampleRate, juce::int64 numSourceFrames);
+
+private:
+    // Onset strength with the local mean removed, so sustained energy does not correlate
+    static std::vector<float> computeOnsetEnvelope(const std::vector<float> &detectionFunction);
+
+    static double findBeatPhase(const std::vector<float> &envelope, double beatPeriod);
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <juce_audio_utils/juce_audio_utils.h>
+#include <atomic>
+#include <vector>
+
+// Something the engine did that the editor shows
+struct EngineEvent {
+    enum class Type {
+        NoteOn,
+        NoteOff,
+        ActiveSampleChanged
+    };
+
+    Type type = Type::NoteOn;
+    int noteNumber = -1;
+    int velocity = 0;
+    int sampleIndex = -1; // ActiveSampleChanged only, -1 when no sample is playing
+};
+
+/**
+ * Single-producer/single-consumer queue of engine events for the editor. The audio thread pushes
+ * into preallocated slots and never waits, so it no longer touches GUI state such as the keyboard
+ * while processing. The editor drains the queue on its frame tick.
+ */
+class EngineEventQueue {
+public:
+    static constexpr int capacity = 256;
+
+    EngineEventQueue() : events(static_cast<size_t>(capacity)) {}
+
+    // Producer (audio thread): the event is dropped while the queue is full
+    void push(const EngineEvent &event) {
+        if (fifo.getFreeSpace() == 0) {
+            overflowed.store(true, std::memory_order_relaxed);
+            return;
+        }
+
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(1, start1, size1, start2, size2);
+        events[static_cast<size_t>(size1 > 0 ? start1 : start2)] = event;
+        fifo.finishedWrite(1);
+    }
+
+    // Consumer: takes the oldest event, returns false when there is none
+    bool pop(EngineEvent &event) {
+        if (fifo.getNumReady() == 0) {
+            return false;
+        }
+
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(1, start1, size1, start2, size2);
+        event = events[static_cast<size_t>(size1 > 0 ? start1 : start2)];
+        fifo.finishedRead(1);
+        return true;
+    }
+
+    // Consumer: drops everything queued, e.g. events from before the editor was opened
+    void discardAll() {
+        fifo.finishedRead(fifo.getNumReady());
+        overflowed.store(false, std::memory_order_relaxed);
+    }
+
+    // Consumer: true once after events were dropped, so state built from them should be reset
+    bool checkAndClearOverflow() { return overflowed.exchange(false, std::memory_order_relaxed); }
+
+private:
+    juce::AbstractFifo fifo{capacity};
+    std::vector<EngineEvent> events;
+    std::atomic<bool> overflowed{false};
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <juce_audio_utils/juce_audio_utils.h>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+/**
+ * Single-producer/single-consumer queue of min/max peaks for the scrolling waveform. The audio
+ * thread folds its output into peaks spanning the time the GUI asked for, so the GUI pops a
+ * handful of peaks per frame instead of scanning raw samples. Peaks cover a fixed time rather
+ * than a fixed number of samples, so the queue holds the same stretch at any sample rate.
+ */
+class PeakQueue {
+public:
+    struct Peak {
+        float min = 0.0f;
+        float max = 0.0f;
+    };
+
+    static constexpr int capacity = 8192;
+
+    PeakQueue() : peaks(static_cast<size_t>(capacity)) {}
+
+    // Consumer: the time each peak should span, the producer switches at its next block
+    void setSecondsPerPeak(double seconds) { requestedSecondsPerPeak.store(seconds, std::memory_order_relaxed); }
+
+    // Producer (audio thread): folds the samples into peaks, dropping them while the queue is full
+    void push(const float *samples, int numSamples, double sampleRate) {
+        const int requested = juce::jmax(1, static_cast<int>(requestedSecondsPerPeak.load(std::memory_order_relaxed)
+                                                             * sampleRate));
+        if (requested != samplesPerPeak) {
+            samplesPerPeak = requested;
+            pendingSamples = 0;
+            resolutionStart.store(peaksPushed, std::memory_order_release);
+        }
+
+        while (numSamples > 0) {
+            const int count = juce::jmin(numSamples, samplesPerPeak - pendingSamples);
+            const auto range = juce::FloatVectorOperations::findMinAndMax(samples, count);
+
+            if (pendingSamples == 0) {
+                pending = {range.getStart(), range.getEnd()};
+            } else {
+                pending.min = juce::jmin(pending.min, range.getStart());
+                pending.max = juce::jmax(pending.max, range.getEnd());
+            }
+
+            pendingSamples += count;
+            samples += count;
+            numSamples -= count;
+
+            if (pendingSamples == samplesPerPeak) {
+                writePending();
+                pendingSamples = 0;
+            }
+        }
+    }
+
+    // Consumer: moves up to maxPeaks of the oldest queued peaks into destination and returns how
+    // many. Peaks from before a resolution change are skipped, and resolutionChanged tells the
+    // consumer to drop the ones it kept
+    int pop(Peak *destination, int maxPeaks, bool &resolutionChanged) {
+        const auto start = resolutionStart.load(std::memory_order_acquire);
+        resolutionChanged = start != consumerResolutionStart;
+        consumerResolutionStart = start;
+
+        if (peaksPopped < start) {
+            const int stale = static_cast<int>(juce::jmin<juce::int64>(start - peaksPopped, fifo.getNumReady()));
+            fifo.finishedRead(stale);
+            peaksPopped += stale;
+        }
+
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(juce::jmin(maxPeaks, fifo.getNumReady()), start1, size1, start2, size2);
+
+        std::copy_n(peaks.begin() + start1, size1, destination);
+        std::copy_n(peaks.begin() + start2, size2, destination + size1);
+
+        fifo.finishedRead(size1 + size2);
+        peaksPopped += size1 + size2;
+        return size1 + size2;
+    }
+
+private:
+    juce::AbstractFifo fifo{capacity};
+    std::vector<Peak> peaks;
+
+    std::atomic<double> requestedSecondsPerPeak{0.001};
+    std::atomic<juce::int64> resolutionStart{0}; // First peak at the current resolution
+
+    // Producer state
+    int samplesPerPeak = 0;
+    int pendingSamples = 0;
+    Peak pending;
+    juce::int64 peaksPushed = 0;
+
+    // Consumer state
+    juce::int64 peaksPopped = 0;
+    juce::int64 consumerResolutionStart = 0;
+
+    void writePending() {
+        if (fifo.getFreeSpace() == 0) {
+            return;
+        }
+
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(1, start1, size1, start2, size2);
+        peaks[static_cast<size_t>(size1 > 0 ? start1 : start2)] = pending;
+        fifo.finishedWrite(1);
+        ++peaksPushed;
+    }
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/**
+ * Hands immutable, reference-counted snapshots to readers on any thread. Unlike
+ * SnapshotPublisher, a reader may keep what it pinned for as long as it likes, e.g. a
+ * voice for the rest of its note. Pinning never locks or allocates, and a reader never
+ * drops the last reference: replaced snapshots are retired and freed on the publishing
+ * side once nothing else holds them.
+ *
+ * Only one thread may publish or collect at a time, callers serialise them if needed.
+ */
+template<typename Snapshot>
+class SharedSnapshotPublisher {
+public:
+    using Ptr = juce::ReferenceCountedObjectPtr<Snapshot>;
+
+    SharedSnapshotPublisher() = default;
+
+    // Publishing thread: swaps in the next snapshot, which may be nullptr, and retires the previous one
+    void publish(Ptr next) {
+        current.store(next.get());
+
+        // A reader that loaded the previous snapshot has taken its reference once the count
+        // of pinning readers drops, none can pick it up after that
+        while (pinningReaders.load() != 0) {
+            std::this_thread::yield();
+        }
+
+        if (latest != nullptr) {
+            retired.push_back(std::move(latest));
+        }
+        latest = std::move(next);
+
+        collectGarbage();
+    }
+
+    // Publishing thread: frees retired snapshots no reader holds any more, returns true while some are left
+    bool collectGarbage() {
+        retired.erase(std::remove_if(retired.begin(), retired.end(), [](const Ptr &snapshot) {
+            return snapshot->getReferenceCount() == 1;
+        }), retired.end());
+
+        return !retired.empty();
+    }
+
+    // Publishing thread: the snapshot most recently published
+    [[nodiscard]] const Snapshot *getLatest() const { return latest.get(); }
+
+    // Any thread: a reference to the current snapshot, nullptr if there is none
+    [[nodiscard]] Ptr pin() const {
+        pinningReaders.fetch_add(1);
+        Ptr pinned(current.load());
+        pinningReaders.fetch_sub(1);
+        return pinned;
+    }
+
+private:
+    std::atomic<Snapshot *> current{nullptr};
+    mutable std::atomic<int> pinningReaders{0};
+    Ptr latest; // Keeps current alive
+    std::vector<Ptr> retired;
+
+    JUCE_DECLARE_NON_COPYABLE(SharedSnapshotPublisher)
+};
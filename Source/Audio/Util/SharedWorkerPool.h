@@ -0,0 +1,65 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <functional>
+
+/**
+ * Worker threads shared by every plugin instance in the process, so a session with many
+ * instances does not start a pool per instance. Subclass it with a default constructor
+ * that picks the thread count and reach it through a juce::SharedResourcePointer. Jobs are
+ * tagged with their owner, so an instance only ever removes or waits for its own.
+ */
+class SharedWorkerPool {
+public:
+    explicit SharedWorkerPool(int numThreads) : pool(numThreads) {}
+
+    virtual ~SharedWorkerPool() { pool.removeAllJobs(true, 30000); }
+
+    // Any thread: runs job on a worker once the jobs queued before it have started
+    void addJob(const void *owner, std::function<void()> job) {
+        pool.addJob(new OwnedJob(owner, std::move(job)), true);
+    }
+
+    // Drops owner's queued jobs. Waits up to timeoutMs for its running ones when
+    // waitForRunning is set, returns false if some were still running after that
+    bool removeJobs(const void *owner, bool waitForRunning, int timeoutMs) {
+        OwnerSelector selector(owner);
+        return pool.removeAllJobs(false, waitForRunning ? timeoutMs : 0, &selector);
+    }
+
+    [[nodiscard]] int getNumThreads() const { return pool.getNumThreads(); }
+
+private:
+    class OwnedJob : public juce::ThreadPoolJob {
+    public:
+        OwnedJob(const void *jobOwner, std::function<void()> jobToRun)
+                : juce::ThreadPoolJob("SharedWorkerPool job"), owner(jobOwner), run(std::move(jobToRun)) {}
+
+        JobStatus runJob() override {
+            run();
+            return jobHasFinished;
+        }
+
+        const void *const owner;
+
+    private:
+        std::function<void()> run;
+    };
+
+    class OwnerSelector : public juce::ThreadPool::JobSelector {
+    public:
+        explicit OwnerSelector(const void *jobOwner) : owner(jobOwner) {}
+
+        bool isJobSuitable(juce::ThreadPoolJob *job) override {
+            auto *ownedJob = dynamic_cast<OwnedJob *>(job);
+            return ownedJob != nullptr && ownedJob->owner == owner;
+        }
+
+    private:
+        const void *owner;
+    };
+
+    juce::ThreadPool pool;
+
+    JUCE_DECLARE_NON_COPYABLE(SharedWorkerPool)
+};
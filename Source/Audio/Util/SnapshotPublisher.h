@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/**
+ * Hands immutable snapshots from the message thread to the audio thread, RCU style.
+ * The audio thread reads the current snapshot through a Reader, which never locks or
+ * allocates. Replaced snapshots are retired and deleted on the publishing thread once
+ * the audio thread no longer holds them.
+ *
+ * There is a single reader slot, so all Readers must live on the audio thread.
+ */
+template<typename Snapshot>
+class SnapshotPublisher {
+public:
+    SnapshotPublisher() = default;
+
+    ~SnapshotPublisher() {
+        delete current.load();
+        for (auto *snapshot: retired) {
+            delete snapshot;
+        }
+    }
+
+    // Publishing thread: swaps in the next snapshot and retires the previous one
+    void publish(std::unique_ptr<Snapshot> next) {
+        if (auto *previous = current.exchange(next.release())) {
+            retired.push_back(previous);
+        }
+
+        collectGarbage();
+    }
+
+    // Publishing thread: deletes retired snapshots the audio thread can no longer see
+    void collectGarbage() {
+        const Snapshot *inUse = hazard.load();
+
+        retired.erase(std::remove_if(retired.begin(), retired.end(), [inUse](Snapshot *snapshot) {
+            if (snapshot == inUse) {
+                return false;
+            }
+            delete snapshot;
+            return true;
+        }), retired.end());
+    }
+
+    // Publishing thread: the snapshot most recently published
+    const Snapshot *getLatest() const { return current.load(); }
+
+    /**
+     * Pins the current snapshot for the lifetime of the reader. Readers may nest, the
+     * outermost one decides which snapshot the whole scope sees.
+     */
+    class Reader {
+    public:
+        explicit Reader(SnapshotPublisher &owner) : publisher(owner) {
+            if (publisher.readerDepth++ > 0) {
+                snapshot = publisher.hazard.load(std::memory_order_relaxed);
+                return;
+            }
+
+            // Announce the snapshot before using it and re-check it is still current,
+            // otherwise the publisher may already have decided to delete it
+            snapshot = publisher.current.load();
+            for (;;) {
+                publisher.hazard.store(snapshot);
+                const Snapshot *latest = publisher.current.load();
+                if (latest == snapshot) {
+                    break;
+                }
+                snapshot = latest;
+            }
+        }
+
+        Reader(const Reader &) = delete;
+
+        Reader &operator=(const Reader &) = delete;
+
+        ~Reader() {
+            if (--publisher.readerDepth == 0) {
+                publisher.hazard.store(nullptr);
+            }
+        }
+
+        const Snapshot *get() const { return snapshot; }
+
+        const Snapshot *operator->() const { return snapshot; }
+
+        const Snapshot &operator*() const { return *snapshot; }
+
+        explicit operator bool() const { return snapshot != nullptr; }
+
+    private:
+        SnapshotPublisher &publisher;
+        const Snapshot *snapshot = nullptr;
+    };
+
+private:
+    std::atomic<Snapshot *> current{nullptr};
+    std::atomic<const Snapshot *> hazard{nullptr};
+    int readerDepth = 0; // Only touched by the reading thread
+    std::vector<Snapshot *> retired;
+};
@@ -5,7 +5,8 @@
 
 //==============================================================================
 EnvelopeComponent::EnvelopeComponent(PluginProcessor &p)
-        : processor(p),
+        : FrameScheduler::Client(*this, 30),
+          processor(p),
           pointManager(),
           renderer(pointManager) {
 
@@ -14,20 +15,14 @@ EnvelopeComponent::EnvelopeComponent(PluginProcessor &p)
     setupRateUI();
     setupPresetsUI();
 
-    startTimerHz(30);
-
     setWantsKeyboardFocus(true);
 }
 
-EnvelopeComponent::~EnvelopeComponent() {
-    stopTimer();
-}
+EnvelopeComponent::~EnvelopeComponent() = default;
 
 void EnvelopeComponent::paint(juce::Graphics &g) {
     g.fillAll(juce::Colours::transparentBlack);
 
-    renderer.drawGrid(g);
-
     double ppqPosition = processor.getTimingManager().getPpqPosition();
     float cycle = std::fmod(static_cast<float>(ppqPosition * currentRate), 1.0f);
 
@@ -44,8 +39,16 @@ void EnvelopeComponent::resized() {
     renderer.setBounds(getWidth(), getHeight() - removeFromTop);
 }
 
-void EnvelopeComponent::timerCallback() {
-    repaint();
+bool EnvelopeComponent::updateFrame() {
+    double ppqPosition = processor.getTimingManager().getPpqPosition();
+    float cycle = std::fmod(static_cast<float>(ppqPosition * currentRate), 1.0f);
+
+    if (cycle == lastCycle) {
+        return false;
+    }
+
+    lastCycle = cycle;
+    return true;
 }
 
 void EnvelopeComponent::mouseDown(const juce::MouseEvent &e) {
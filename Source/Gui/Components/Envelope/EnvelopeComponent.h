@@ -11,8 +11,9 @@
 #include "EnvelopePointManager.h"
 #include "EnvelopeRenderer.h"
 #include "EnvelopeShapeButton.h"
+#include "../../FrameScheduler.h"
 
-class EnvelopeComponent : public juce::Component, private juce::Timer {
+class EnvelopeComponent : public juce::Component, private FrameScheduler::Client {
 public:
 
     explicit EnvelopeComponent(PluginProcessor &p);
@@ -44,7 +45,8 @@ public:
 private:
     void handlePointsChanged();
 
-    void timerCallback() override;
+    // Repaints only when the playhead has moved along the envelope
+    bool updateFrame() override;
 
     void resizeControls(int width, int topPadding = 5);
 
@@ -63,6 +65,7 @@ private:
     std::unique_ptr<juce::ComboBox> rateComboBox;
     Models::LFORate currentRateEnum = Models::LFORate::Quarter;
     float currentRate = 1.0f;
+    float lastCycle = -1.0f; // Playhead position drawn last
 
     bool isCreatingSelectionArea = false;
     juce::Point<float> selectionStart;
@@ -10,9 +10,62 @@ EnvelopeRenderer::EnvelopeRenderer(EnvelopePointManager &pointManager,
 }
 
 void EnvelopeRenderer::drawEnvelope(juce::Graphics &g, float transportPosition) {
-    drawEnvelopeLine(g);
+    // Drawn at the display's pixel density, so the cached curve stays as sharp as a direct one
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    if (!isLayerCurrent(scale)) {
+        redrawLayer(scale);
+    }
+
+    if (layer.isValid()) {
+        const auto margin = static_cast<float>(getLayerMargin());
+        g.drawImageTransformed(layer, juce::AffineTransform::scale(1.0f / scale).translated(-margin, -margin));
+    }
+
     drawPositionMarker(g, transportPosition);
-    drawPoints(g);
+}
+
+bool EnvelopeRenderer::isLayerCurrent(float scale) const {
+    const auto &points = pointManager.getPoints();
+    if (!layer.isValid() || scale != layerScale || width != layerGridWidth || height != layerGridHeight
+        || points.size() != layerPoints.size()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < points.size(); ++i) {
+        if (!(layerPoints[i] == LayerPoint{points[i]->position, points[i]->curvature, points[i]->selected})) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void EnvelopeRenderer::redrawLayer(float scale) {
+    const auto &points = pointManager.getPoints();
+    layerPoints.clear();
+    for (const auto &point: points) {
+        layerPoints.push_back({point->position, point->curvature, point->selected});
+    }
+    layerScale = scale;
+    layerGridWidth = width;
+    layerGridHeight = height;
+
+    const int margin = getLayerMargin();
+    const int layerWidth = juce::roundToInt(static_cast<float>(width + 2 * margin) * scale);
+    const int layerHeight = juce::roundToInt(static_cast<float>(height + 2 * margin) * scale);
+    if (width <= 0 || height <= 0 || layerWidth <= 0 || layerHeight <= 0) {
+        layer = {};
+        return;
+    }
+
+    layer = juce::Image(juce::Image::ARGB, layerWidth, layerHeight, true);
+    juce::Graphics layerGraphics(layer);
+    layerGraphics.addTransform(juce::AffineTransform::translation(static_cast<float>(margin),
+                                                                  static_cast<float>(margin)).scaled(scale));
+
+    drawGrid(layerGraphics);
+    drawEnvelopeLine(layerGraphics);
+    drawPoints(layerGraphics);
 }
 
 void EnvelopeRenderer::drawEnvelopeLine(juce::Graphics &g) {
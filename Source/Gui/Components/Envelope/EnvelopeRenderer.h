@@ -2,6 +2,7 @@
 
 #include <juce_gui_basics/juce_gui_basics.h>
 #include "EnvelopePointManager.h"
+#include <vector>
 
 /**
  * Handles rendering of envelope points, lines, curves, and selection areas
@@ -16,6 +17,8 @@ public:
 
     ~EnvelopeRenderer() = default;
 
+    // Grid, curve and points come from a cached layer that is only redrawn when the points or
+    // the size change, so moving the position marker costs one image blit
     void drawEnvelope(juce::Graphics &g, float transportPosition);
 
     void drawEnvelopeLine(juce::Graphics &g);
@@ -38,8 +41,23 @@ private:
 
     int horizontalDivisions = 10;
     int verticalDivisions = 4;
-    int height;
-    int width;
+    int height = 0;
+    int width = 0;
+
+    // What the layer was drawn from, compared each paint to spot edits
+    struct LayerPoint {
+        juce::Point<float> position;
+        float curvature = 0.0f;
+        bool selected = false;
+
+        bool operator==(const LayerPoint &) const = default;
+    };
+
+    juce::Image layer;
+    float layerScale = 0.0f;
+    int layerGridWidth = 0;
+    int layerGridHeight = 0;
+    std::vector<LayerPoint> layerPoints;
 
     juce::Colour envelopeColor = juce::Colour(0xff52bfd9);
     juce::Colour selectedPointColor = juce::Colours::white;
@@ -49,4 +67,11 @@ private:
     juce::Colour selectionOutlineColor = juce::Colour(0xff52bfd9);
 
     float pointRadius = 6.0f;
+
+    // Room around the grid for the points and strokes that reach past its edges
+    int getLayerMargin() const { return static_cast<int>(std::ceil(pointRadius)) + 2; }
+
+    bool isLayerCurrent(float scale) const;
+
+    void redrawLayer(float scale);
 }; 
\ No newline at end of file
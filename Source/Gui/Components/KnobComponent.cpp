@@ -11,14 +11,14 @@
 
 KnobComponent::KnobComponent(ModulationMatrix &modMatrix, const juce::String &tooltip)
         : modMatrix(modMatrix),
-          juce::Slider(juce::Slider::RotaryVerticalDrag, juce::Slider::TextBoxBelow) {
+          juce::Slider(juce::Slider::RotaryVerticalDrag, juce::Slider::TextBoxBelow),
+          FrameScheduler::Client(*this, 30) {
     setTooltip(tooltip);
     setTextBoxStyle(juce::Slider::TextBoxBelow, false, 50, 12);
     setColour(juce::Slider::textBoxTextColourId, juce::Colours::white);
     setColour(juce::Slider::textBoxBackgroundColourId, juce::Colours::transparentBlack);
     setColour(juce::Slider::textBoxOutlineColourId, juce::Colours::transparentBlack);
     setNumDecimalPlacesToDisplay(0);
-    startTimerHz(30);
 }
 
 void KnobComponent::paint(juce::Graphics &g) {
@@ -118,13 +118,17 @@ void KnobComponent::itemDropped(const juce::DragAndDropTarget::SourceDetails &dr
     repaint();
 }
 
-void KnobComponent::timerCallback() {
-    if (isModulated) {
-        auto [baseValue, modValue] = modMatrix.getParamAndModulationValue(getName());
-        if (modValue != modulationValue) {
-            modulationValue = modValue;
-            isModulated = modValue != 0.0f;
-        }
-        repaint();
+bool KnobComponent::updateFrame() {
+    if (!isModulated) {
+        return false;
     }
+
+    auto [baseValue, modValue] = modMatrix.getParamAndModulationValue(getName());
+    if (modValue == modulationValue) {
+        return false;
+    }
+
+    modulationValue = modValue;
+    isModulated = modValue != 0.0f;
+    return true;
 }
\ No newline at end of file
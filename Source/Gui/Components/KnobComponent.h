@@ -6,10 +6,11 @@
 
 #include <juce_gui_basics/juce_gui_basics.h>
 #include "../../Shared/ModulationMatrix.h"
+#include "../FrameScheduler.h"
 
 
 class KnobComponent : public juce::Slider,
-                      public juce::Timer,
+                      private FrameScheduler::Client,
                       public juce::DragAndDropTarget {
 public:
     KnobComponent(ModulationMatrix &modMatrix, const juce::String &tooltip);
@@ -30,11 +31,12 @@ public:
 
     void itemDropped(const juce::DragAndDropTarget::SourceDetails &dragSourceDetails) override;
 
-    void timerCallback() override;
-
 private:
     ModulationMatrix &modMatrix;
     bool dragHighlight = false;
     bool isModulated = false;
     float modulationValue = 0.0f;
+
+    // Repaints only when the modulation has moved
+    bool updateFrame() override;
 }; 
\ No newline at end of file
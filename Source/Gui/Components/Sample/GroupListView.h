@@ -4,12 +4,13 @@
 #include "../../../Audio/PluginProcessor.h"
 #include "../Icon.h"
 #include "../../Sections/BaseSection.h"
+#include "../../FrameScheduler.h"
 
 class GroupListView
-        : public juce::Component, public juce::Timer {
+        : public juce::Component, private FrameScheduler::Client {
 public:
     explicit GroupListView(PluginProcessor &p)
-            : processor(p) {
+            : FrameScheduler::Client(*this, 5), processor(p) {
 
         // Make the sliders and controls for each group
         for (int i = 0; i < MAX_GROUPS; ++i) {
@@ -72,9 +73,6 @@ public:
 
         // Set initial size
         setSize(300, 200);
-
-        // Start a timer to periodically update the UI
-        startTimerHz(5);
     }
 
     ~GroupListView() override = default;
@@ -205,7 +203,8 @@ public:
         }
     }
 
-    void timerCallback() override {
+    // Polled a few times a second to follow the groups
+    bool updateFrame() override {
         // Get the current number of groups
         const int numGroups = processor.getSampleManager().getNumGroups();
 
@@ -252,6 +251,7 @@ public:
 
         // Resize to update the layout
         resized();
+        return false;
     }
 
     void paint(juce::Graphics &g) override {
@@ -1,32 +1,22 @@
 #pragma once
 
 #include <juce_audio_utils/juce_audio_utils.h>
-#include <juce_dsp/juce_dsp.h>
 #include "../../../Audio/Sampler/SampleManager.h"
-#include "../../../Audio/Sampler/OnsetDetector.h"
+#include "../../FrameScheduler.h"
 
 class SampleDetailComponent
     : public juce::Component
-    , private juce::ChangeListener
+    , private FrameScheduler::Client
     , public juce::KeyListener
 {
 public:
     SampleDetailComponent(SampleManager& manager)
-        : sampleManager(manager)
+        : FrameScheduler::Client(*this, analysisPollRate)
+        , sampleManager(manager)
     {
-        // Initialize the thumbnail cache and source
-        thumbnailCache = std::make_unique<juce::AudioThumbnailCache>(5);
-        thumbnail =
-            std::make_unique<juce::AudioThumbnail>(4096, formatManager, *thumbnailCache);
-
-        formatManager.registerBasicFormats();
-
         startMarkerPosition = 0.0;
         endMarkerPosition = 1.0;
 
-        // Start listening for changes to the thumbnail
-        thumbnail->addChangeListener(this);
-
         // Create back arrow path
         backArrowPath.startNewSubPath(10.0f, 10.0f);
         backArrowPath.lineTo(5.0f, 15.0f);
@@ -53,7 +43,6 @@ public:
     }
 
     ~SampleDetailComponent() override { 
-        thumbnail->removeChangeListener(this); 
         removeKeyListener(this);
     }
 
@@ -78,19 +67,20 @@ public:
                     startMarkerPosition = sound->getStartMarkerPosition();
                     endMarkerPosition = sound->getEndMarkerPosition();
 
-                    // Clear previous thumbnail
-                    thumbnail->clear();
-
-                    // Create a reader for the sample data
-                    auto& audioData = *sound->getAudioData();
-                    double sampleRate = sound->getSourceSampleRate();
-
-                    thumbnail->setSource(&audioData, sampleRate, static_cast<juce::int64>(currentSampleIndex));
+                    // The waveform is drawn from the analysis made at import, wait for it if it is still running
+                    if (const auto* analysis = sound->getAnalysis())
+                    {
+                        waitingForAnalysis = false;
 
-                    // If no onset markers exist, detect them
-                    if (sound->getOnsetMarkers().empty())
+                        // If no onset markers exist, restore the analysed ones
+                        if (sound->getOnsetMarkers().empty())
+                        {
+                            sound->setOnsetMarkers(analysis->onsetMarkers);
+                        }
+                    }
+                    else
                     {
-                        detectOnsets();
+                        waitingForAnalysis = true;
                     }
 
                     repaint();
@@ -99,32 +89,10 @@ public:
         }
     }
 
-    // Method to rebuild the waveform without changing the current sample
+    // Redraws the waveform without changing the current sample, e.g. after its gain changed
     void rebuildWaveform()
     {
-        if (currentSampleIndex >= 0 && currentSampleIndex < sampleManager.getNumSamples())
-        {
-            // Get the sample sound
-            if (auto* sound = sampleManager.getSampleSound(currentSampleIndex))
-            {
-                // Clear previous thumbnail
-                thumbnail->clear();
-
-                // Create a reader for the sample data
-                auto& audioData = *sound->getAudioData();
-                double sampleRate = sound->getSourceSampleRate();
-
-                // Set the sample data to the thumbnail
-                thumbnail->reset(audioData.getNumChannels(),
-                                 sampleRate,
-                                 audioData.getNumSamples());
-
-                // Add the sample data to the thumbnail
-                thumbnail->addBlock(0, audioData, 0, audioData.getNumSamples());
-
-                repaint();
-            }
-        }
+        repaint();
     }
 
     void paint(juce::Graphics& g) override
@@ -152,11 +120,13 @@ public:
         g.setColour(juce::Colour(0xff3a3a3a));
         g.fillRect(bounds);
 
+        auto* sound = sampleManager.getSampleSound(currentSampleIndex);
+        const auto* analysis = sound != nullptr ? sound->getAnalysis() : nullptr;
+
         // Draw waveform if available
-        if (thumbnail->getTotalLength() > 0.0)
+        if (analysis != nullptr && analysis->peaks.getNumFrames() > 0)
         {
-            g.setColour(juce::Colour(0xffbf52d9));
-            thumbnail->drawChannels(g, bounds, 0.0, thumbnail->getTotalLength(), 1.0f);
+            drawWaveform(g, analysis->peaks, sound->getPlaybackGain(), bounds);
 
             // Calculate marker positions in pixels
             float startPixel = bounds.getX() + bounds.getWidth() * startMarkerPosition;
@@ -191,35 +161,32 @@ public:
                        juce::Justification::centred);
 
             // Draw onset markers
-            if (auto* sound = sampleManager.getSampleSound(currentSampleIndex))
-            {
-                const auto& onsetMarkers = sound->getOnsetMarkers();
-
-                for (int i = 0; i < onsetMarkers.size(); ++i)
-                {
-                    float onsetPosition = onsetMarkers[i];
-                    float onsetPixel = bounds.getX() + bounds.getWidth() * onsetPosition;
-
-                    // Use a different color if this marker is selected
-                    if (i == selectedMarkerIndex) {
-                        g.setColour(juce::Colours::red); // Selected marker is red
-                    } else {
-                        g.setColour(juce::Colour(0xff52bfd9)); // Blue color for onset markers
-                    }
+            const auto& onsetMarkers = sound->getOnsetMarkers();
 
-                    // Draw a thinner line for onset markers
-                    g.drawLine(
-                        onsetPixel, bounds.getY(), onsetPixel, bounds.getBottom(), 1.0f);
-
-                    // Draw a downward-facing triangle at the top of the marker
-                    float triangleSize = 8.0f; // Slightly larger than the circle
-                    juce::Path trianglePath;
-                    trianglePath.startNewSubPath(onsetPixel, bounds.getY() + triangleSize);
-                    trianglePath.lineTo(onsetPixel - triangleSize/2, bounds.getY());
-                    trianglePath.lineTo(onsetPixel + triangleSize/2, bounds.getY());
-                    trianglePath.closeSubPath();
-                    g.fillPath(trianglePath);
+            for (int i = 0; i < onsetMarkers.size(); ++i)
+            {
+                float onsetPosition = onsetMarkers[i];
+                float onsetPixel = bounds.getX() + bounds.getWidth() * onsetPosition;
+
+                // Use a different color if this marker is selected
+                if (i == selectedMarkerIndex) {
+                    g.setColour(juce::Colours::red); // Selected marker is red
+                } else {
+                    g.setColour(juce::Colour(0xff52bfd9)); // Blue color for onset markers
                 }
+
+                // Draw a thinner line for onset markers
+                g.drawLine(
+                    onsetPixel, bounds.getY(), onsetPixel, bounds.getBottom(), 1.0f);
+
+                // Draw a downward-facing triangle at the top of the marker
+                float triangleSize = 8.0f; // Slightly larger than the circle
+                juce::Path trianglePath;
+                trianglePath.startNewSubPath(onsetPixel, bounds.getY() + triangleSize);
+                trianglePath.lineTo(onsetPixel - triangleSize/2, bounds.getY());
+                trianglePath.lineTo(onsetPixel + triangleSize/2, bounds.getY());
+                trianglePath.closeSubPath();
+                g.fillPath(trianglePath);
             }
         }
         else
@@ -227,7 +194,8 @@ public:
             // No waveform available
             g.setColour(juce::Colours::white.withAlpha(0.5f));
             g.setFont(juce::Font(juce::FontOptions(14.0f)));
-            g.drawText("Waveform not available", bounds, juce::Justification::centred);
+            g.drawText(sound != nullptr && analysis == nullptr ? "Analysing..." : "Waveform not available",
+                       bounds, juce::Justification::centred);
         }
     }
 
@@ -340,8 +308,8 @@ public:
 
     void clearSampleData()
     {
-        // Clear the thumbnail and reset state
-        thumbnail->clear();
+        // Reset state
+        waitingForAnalysis = false;
         currentSampleIndex = -1;
         sampleName = "No Sample";
         startMarkerPosition = 0.0;
@@ -354,14 +322,8 @@ public:
     {
         if (currentSampleIndex >= 0)
         {
-            // Get the sampler sound for this index
-            SamplerSound* sound = sampleManager.getSampleSound(currentSampleIndex);
-
-            if (sound != nullptr)
-            {
-                // Apply markers to the sound
-                sound->setMarkerPositions(startMarkerPosition, endMarkerPosition);
-            }
+            // Apply markers to the sound
+            sampleManager.setSampleMarkerPositions(currentSampleIndex, startMarkerPosition, endMarkerPosition);
         }
     }
 
@@ -531,10 +493,15 @@ public:
         return false; // We only care about keyPressed
     }
 
-    void changeListenerCallback(juce::ChangeBroadcaster*) override
+    bool updateFrame() override
     {
-        // Repaint when thumbnail changes
-        repaint();
+        if (!waitingForAnalysis)
+            return false;
+
+        // Analyses are delivered on the message thread, draw the waveform once this one's is in
+        auto* sound = sampleManager.getSampleSound(currentSampleIndex);
+        waitingForAnalysis = sound != nullptr && sound->getAnalysis() == nullptr;
+        return !waitingForAnalysis;
     }
 
     void resized() override
@@ -563,13 +530,12 @@ public:
     std::function<void()> onBackButtonClicked;
 
 private:
-    SampleManager& sampleManager;
+    static constexpr int analysisPollRate = 10;
 
-    std::unique_ptr<juce::AudioThumbnailCache> thumbnailCache;
-    std::unique_ptr<juce::AudioThumbnail> thumbnail;
-    juce::AudioFormatManager formatManager;
+    SampleManager& sampleManager;
 
     int currentSampleIndex = -1;
+    bool waitingForAnalysis = false;
     juce::String sampleName;
 
     float startMarkerPosition = 0.0f;
@@ -624,19 +590,60 @@ private:
         return -1;
     }
 
-    void detectOnsets()
+    // One column per pixel from the pyramid level matching the zoom, min/max with the RMS inside it
+    void drawWaveform(juce::Graphics& g, const PeakPyramid& peaks, float gain, juce::Rectangle<int> bounds)
     {
-        if (auto* sound = sampleManager.getSampleSound(currentSampleIndex))
+        const int numChannels = peaks.getNumChannels();
+        const int width = bounds.getWidth();
+        if (numChannels == 0 || width <= 0)
+            return;
+
+        const double framesPerPixel = static_cast<double>(peaks.getNumFrames()) / width;
+        const int level = peaks.getLevelForResolution(framesPerPixel);
+        const double peaksPerPixel = framesPerPixel / static_cast<double>(PeakPyramid::getFramesPerPeak(level));
+        const float laneHeight = bounds.getHeight() / static_cast<float>(numChannels);
+
+        juce::RectangleList<float> peakColumns, rmsColumns;
+
+        for (int channel = 0; channel < numChannels; ++channel)
         {
-            // Create an onset detector
-            OnsetDetector detector;
-
-            // Get audio data
-            auto& audioData = *sound->getAudioData();
-            double sampleRate = sound->getSourceSampleRate();
-            // Set the onset markers
-            sound->setOnsetMarkers(detector.detectOnsets(audioData, sampleRate));
+            const auto& levelPeaks = peaks.getPeaks(level, channel);
+            const float laneTop = bounds.getY() + laneHeight * channel;
+            const float centre = laneTop + laneHeight * 0.5f;
+            const float scale = laneHeight * 0.5f * gain;
+
+            auto toY = [&](float value)
+            {
+                return juce::jlimit(laneTop, laneTop + laneHeight, centre - value * scale);
+            };
+
+            for (int x = 0; x < width; ++x)
+            {
+                const auto first = static_cast<size_t>(x * peaksPerPixel);
+                const auto last = juce::jmin(levelPeaks.size(),
+                                             juce::jmax(first + 1, static_cast<size_t>((x + 1) * peaksPerPixel)));
+                if (first >= last)
+                    break;
+
+                float min = levelPeaks[first].min, max = levelPeaks[first].max, sumSquares = 0.0f;
+                for (auto i = first; i < last; ++i)
+                {
+                    min = juce::jmin(min, levelPeaks[i].min);
+                    max = juce::jmax(max, levelPeaks[i].max);
+                    sumSquares += levelPeaks[i].rms * levelPeaks[i].rms;
+                }
+                const float rms = std::sqrt(sumSquares / static_cast<float>(last - first));
+
+                const auto columnX = static_cast<float>(bounds.getX() + x);
+                peakColumns.addWithoutMerging({columnX, toY(max), 1.0f, juce::jmax(1.0f, toY(min) - toY(max))});
+                rmsColumns.addWithoutMerging({columnX, toY(rms), 1.0f, juce::jmax(1.0f, toY(-rms) - toY(rms))});
+            }
         }
+
+        g.setColour(juce::Colour(0xffbf52d9));
+        g.fillRectList(peakColumns);
+        g.setColour(juce::Colour(0xffd98ce8));
+        g.fillRectList(rmsColumns);
     }
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleDetailComponent)
@@ -2,7 +2,7 @@
 #include "SampleRow.h"
 
 SampleList::SampleList(PluginProcessor &p)
-        : processor(p) {
+        : FrameScheduler::Client(*this, 30), processor(p) {
     // Create sample list table
     sampleListBox = std::make_unique<juce::TableListBox>("Sample List", this);
     sampleListBox->setHeaderHeight(0); // Remove the header by setting height to 0
@@ -62,7 +62,8 @@ void SampleList::resized() {
 }
 
 int SampleList::getNumRows() {
-    return processor.getSampleManager().getNumSamples();
+    // Files still importing are listed after the loaded samples
+    return processor.getSampleManager().getNumSamples() + processor.getSampleManager().getNumPendingImports();
 }
 
 void SampleList::paintRowBackground(
@@ -166,7 +167,28 @@ void SampleList::paintCell(juce::Graphics &g,
                            int width,
                            int height,
                            bool /*rowIsSelected*/) {
+    // Loaded samples are drawn by their SampleRow, only pending imports are painted here
+    auto &sampleManager = processor.getSampleManager();
+    const int pendingIndex = rowNumber - static_cast<int>(sampleManager.getNumSamples());
 
+    if (columnId != 1 || pendingIndex < 0 || pendingIndex >= sampleManager.getNumPendingImports())
+        return;
+
+    auto bounds = juce::Rectangle<int>(0, 0, width, height).reduced(8, 0);
+
+    g.setColour(juce::Colours::lightgrey);
+    g.setFont(juce::FontOptions(14.0f));
+    g.drawText(sampleManager.getPendingImportName(pendingIndex),
+               bounds.removeFromLeft(bounds.getWidth() / 2),
+               juce::Justification::centredLeft,
+               true);
+
+    // Progress bar
+    auto bar = bounds.reduced(4, height / 2 - 3).toFloat();
+    g.setColour(juce::Colour(0xff222222));
+    g.fillRoundedRectangle(bar, 3.0f);
+    g.setColour(juce::Colour(0xffbf52d9));
+    g.fillRoundedRectangle(bar.withWidth(bar.getWidth() * sampleManager.getPendingImportProgress(pendingIndex)), 3.0f);
 }
 
 void SampleList::deleteKeyPressed(int /*rowNumber*/) {
@@ -184,7 +206,7 @@ void SampleList::deleteKeyPressed(int /*rowNumber*/) {
 void SampleList::setActiveSampleIndex(int index) {
     if (activeSampleIndex != index) {
         activeSampleIndex = index;
-        sampleListBox->repaint();
+        markDirty();
     }
 }
 
@@ -192,6 +214,10 @@ void SampleList::updateContent() {
     sampleListBox->updateContent();
 }
 
+bool SampleList::updateFrame() {
+    return processor.getSampleManager().getNumPendingImports() > 0;
+}
+
 void SampleList::handleSliderValueChanged(int rowNumber, double value) {
     if (rowNumber >= 0 && rowNumber < processor.getSampleManager().getNumSamples()) {
         // Update the sample's probability
@@ -208,8 +234,11 @@ SampleList::refreshComponentForCell(int rowNumber,
                                     int columnId,
                                     bool /*isRowSelected*/,
                                     juce::Component *existingComponentToUpdate) {
-    if (rowNumber >= processor.getSampleManager().getNumSamples())
+    if (rowNumber >= processor.getSampleManager().getNumSamples()) {
+        // Pending imports have no row component, they are painted in paintCell
+        delete existingComponentToUpdate;
         return nullptr;
+    }
 
     if (columnId == 1) {
         // Get the sample sound
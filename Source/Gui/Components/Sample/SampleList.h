@@ -4,10 +4,12 @@
 #include "../../../Audio/PluginProcessor.h"
 #include "../Icon.h"
 #include "BinaryData.h"
+#include "../../FrameScheduler.h"
 
 class SampleList
     : public juce::Component
     , public juce::TableListBoxModel
+    , private FrameScheduler::Client
 {
 public:
     explicit SampleList(PluginProcessor& processor);
@@ -61,6 +63,9 @@ public:
     // Toggle onset randomization for a sample
     void toggleOnsetRandomization(int sampleIndex);
 private:
+    // Animates the progress of pending imports
+    bool updateFrame() override;
+
     std::unique_ptr<juce::TableListBox> sampleListBox;
 
     // Track the currently active sample for highlighting
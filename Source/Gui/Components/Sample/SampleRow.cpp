@@ -32,7 +32,7 @@ SampleRow::SampleRow(SampleList *owner, int row, SamplerSound *sound)
     onsetIcon = std::make_unique<Icon>(BinaryData::threelines_svg, BinaryData::threelines_svgSize, 16.0f);
     onsetIcon->setNormalColour(juce::Colours::lightgrey);
     onsetIcon->setTooltip(
-            "Toggle onset randomization - each trigger will randomize the start position based on onset in the edit view.");
+            "Toggle slice playback - each trigger plays one slice between the onsets in the edit view.");
     addAndMakeVisible(onsetIcon.get());
 
     // Add all components
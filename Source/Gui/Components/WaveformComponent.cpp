@@ -1,14 +1,11 @@
 #include "WaveformComponent.h"
 
-WaveformComponent::WaveformComponent() {
+WaveformComponent::WaveformComponent()
+        : FrameScheduler::Client(*this, 60), popScratch(static_cast<size_t>(PeakQueue::capacity)) {
     setInterceptsMouseClicks(false, true);
-    setupWaveformRendering();
-    startTimerHz(30);
 }
 
-WaveformComponent::~WaveformComponent() {
-    stopTimer();
-}
+WaveformComponent::~WaveformComponent() = default;
 
 void WaveformComponent::paint(juce::Graphics &g) {
     g.fillAll(backgroundColour);
@@ -18,31 +15,39 @@ void WaveformComponent::paint(juce::Graphics &g) {
 }
 
 void WaveformComponent::resized() {
-    if (waveformData.size() != static_cast<size_t>(getWidth()) && getWidth() > 0) {
-        waveformData.resize(getWidth(), 0.0f);
-        waveformPeaks.resize(getWidth());
-        waveformCache = juce::Image(juce::Image::ARGB, getWidth(), getHeight(), true);
-        waveformNeedsRedraw.store(true);
+    if (getWidth() <= 0 || getHeight() <= 0) {
+        return;
+    }
+
+    if (history.size() != static_cast<size_t>(getWidth())) {
+        history.assign(static_cast<size_t>(getWidth()), {});
+        historyWrite = 0;
+        updatePeakResolution();
     }
+
+    waveformCache = juce::Image(juce::Image::ARGB, getWidth(), getHeight(), true);
+    fullRedrawNeeded = true;
 }
 
-void WaveformComponent::setSampleRate(float newSampleRate) {
-    sampleRate = newSampleRate;
+void WaveformComponent::setPeakQueue(PeakQueue *queue) {
+    peakQueue = queue;
+    updatePeakResolution();
 }
 
 void WaveformComponent::setTimeRange(float seconds) {
     timeRangeInSeconds = seconds;
-    waveformNeedsRedraw.store(true);
+    updatePeakResolution();
+    fullRedrawNeeded = true;
 }
 
 void WaveformComponent::setWaveformScaleFactor(float scale) {
     waveformScaleFactor = scale;
-    waveformNeedsRedraw.store(true);
+    fullRedrawNeeded = true;
 }
 
 void WaveformComponent::setWaveformColour(juce::Colour colour) {
     waveformColour = colour;
-    waveformNeedsRedraw.store(true);
+    fullRedrawNeeded = true;
 }
 
 void WaveformComponent::setBackgroundColour(juce::Colour colour) {
@@ -52,112 +57,91 @@ void WaveformComponent::setBackgroundColour(juce::Colour colour) {
 
 void WaveformComponent::setWaveformAlpha(float alpha) {
     waveformAlpha = juce::jlimit(0.0f, 1.0f, alpha);
-    waveformNeedsRedraw.store(true);
+    fullRedrawNeeded = true;
 }
 
-void WaveformComponent::pushAudioBuffer(const float *audioData, int numSamples) {
-    if (auto localQueue = audioBufferQueueWeak.lock()) {
-        localQueue->push(audioData, numSamples);
-        waveformNeedsRedraw.store(true);
+void WaveformComponent::updatePeakResolution() {
+    if (peakQueue != nullptr && !history.empty()) {
+        peakQueue->setSecondsPerPeak(timeRangeInSeconds / static_cast<double>(history.size()));
     }
 }
 
-void WaveformComponent::setupWaveformRendering() {
-    audioBufferQueue = std::make_shared<AudioBufferQueue>();
-    audioBufferQueueWeak = audioBufferQueue;
-
-    waveformData.resize(getWidth() > 0 ? getWidth() : 300, 0.0f);
-    waveformPeaks.resize(waveformData.size());
-
-    waveformCache = juce::Image(juce::Image::ARGB,
-                                getWidth() > 0 ? getWidth() : 300,
-                                getHeight() > 0 ? getHeight() : 150,
-                                true);
-}
-
-void WaveformComponent::updateWaveformCache() {
-    // Check if component has been resized
-    if (waveformData.size() != static_cast<size_t>(getWidth()) && getWidth() > 0) {
-        waveformData.resize(getWidth(), 0.0f);
-        waveformPeaks.resize(getWidth());
-        waveformCache = juce::Image(juce::Image::ARGB, getWidth(), getHeight(), true);
+void WaveformComponent::readQueuedPeaks() {
+    if (peakQueue == nullptr || history.empty()) {
+        return;
     }
 
-    // Fetch the audio data for the visible time range
-    if (audioBufferQueue != nullptr) {
-        // Calculate how many samples we need based on the time range
-        size_t samplesForTimeRange = static_cast<size_t>(timeRangeInSeconds * sampleRate);
-
-        // Resize waveformData if necessary to match time range
-        if (waveformData.size() != samplesForTimeRange && samplesForTimeRange > 0) {
-            waveformData.resize(samplesForTimeRange, 0.0f);
-        }
+    bool resolutionChanged = false;
+    const int numPopped = peakQueue->pop(popScratch.data(), static_cast<int>(popScratch.size()), resolutionChanged);
 
-        // Get samples for the visible range - we want the most recent samples, so offset is 0
-        audioBufferQueue->getVisibleSamples(waveformData.data(), waveformData.size(), 0);
+    // Peaks kept from before were at another time scale
+    if (resolutionChanged) {
+        std::fill(history.begin(), history.end(), PeakQueue::Peak{});
+        historyWrite = 0;
+        fullRedrawNeeded = true;
     }
 
-    // Prepare the peak data structure
-    waveformPeaks.resize(getWidth());
-
-    // Process the raw sample data into min-max peaks for each pixel column
-    const float samplesPerPixel = static_cast<float>(waveformData.size()) / getWidth();
-
-    // For each horizontal pixel in our display
-    for (int x = 0; x < getWidth(); ++x) {
-
-        // For left-to-right flow, we need to reverse the x index used to look up samples
-        // This makes newest samples appear on the right and older samples flow left
-        int reverseX = getWidth() - 1 - x;
-
-        // Calculate the range of samples that correspond to this pixel
-        const int startSample = static_cast<int>(reverseX * samplesPerPixel);
-        const int endSample = static_cast<int>((reverseX + 1) * samplesPerPixel);
+    for (int i = 0; i < numPopped; ++i) {
+        history[historyWrite] = popScratch[static_cast<size_t>(i)];
+        historyWrite = (historyWrite + 1) % history.size();
+    }
 
-        // Find min and max values in this range
-        float minValue = 0.0f;
-        float maxValue = 0.0f;
+    newColumns += numPopped;
+}
 
-        // Make sure we don't go out of bounds
-        const int numSamples = std::min(endSample, static_cast<int>(waveformData.size()));
+void WaveformComponent::redrawWaveformCache() {
+    waveformCache.clear(waveformCache.getBounds(), juce::Colours::transparentBlack);
+    drawColumns(0, waveformCache.getWidth());
+}
 
-        for (int sample = startSample; sample < numSamples; ++sample) {
-            const float value = waveformData[sample];
-            minValue = std::min(minValue, value);
-            maxValue = std::max(maxValue, value);
-        }
+void WaveformComponent::scrollWaveformCache(int numColumns) {
+    const int width = waveformCache.getWidth();
+    const int keptColumns = width - numColumns;
 
-        // Store the peak data
-        waveformPeaks[x].min = minValue * waveformScaleFactor;
-        waveformPeaks[x].max = maxValue * waveformScaleFactor;
-    }
+    waveformCache.moveImageSection(0, 0, numColumns, 0, keptColumns, waveformCache.getHeight());
+    waveformCache.clear({keptColumns, 0, numColumns, waveformCache.getHeight()}, juce::Colours::transparentBlack);
+    drawColumns(keptColumns, numColumns);
+}
 
-    // Draw the waveform to the cache image
+void WaveformComponent::drawColumns(int firstColumn, int numColumns) {
     juce::Graphics g(waveformCache);
-    g.fillAll(juce::Colours::transparentBlack);
 
     // Draw waveform peaks with the specified alpha
     g.setColour(waveformColour.withAlpha(waveformAlpha));
 
-    for (int x = 0; x < static_cast<int>(waveformPeaks.size()) && x < getWidth(); ++x) {
+    // Oldest peaks on the left, so newer audio flows in from the right
+    const auto height = static_cast<float>(waveformCache.getHeight());
+    const int lastColumn = juce::jmin(firstColumn + numColumns, static_cast<int>(history.size()));
+    for (int x = firstColumn; x < lastColumn; ++x) {
+        const auto &peak = history[(historyWrite + static_cast<size_t>(x)) % history.size()];
+
         // Calculate the y positions for min and max values
-        const float minY = juce::jmap(waveformPeaks[x].min, -1.0f, 1.0f,
-                                      static_cast<float>(getHeight()), 0.0f);
-        const float maxY = juce::jmap(waveformPeaks[x].max, -1.0f, 1.0f,
-                                      static_cast<float>(getHeight()), 0.0f);
+        const float minY = juce::jmap(peak.min * waveformScaleFactor, -1.0f, 1.0f, height, 0.0f);
+        const float maxY = juce::jmap(peak.max * waveformScaleFactor, -1.0f, 1.0f, height, 0.0f);
 
-        // Draw a vertical line from min to max
-        g.drawLine(static_cast<float>(x), minY, static_cast<float>(x), maxY, 1.0f);
+        // Draw a vertical line from min to max, centred on the pixel so it stays inside its column
+        const float columnX = static_cast<float>(x) + 0.5f;
+        g.drawLine(columnX, minY, columnX, maxY, 1.0f);
     }
 }
 
-void WaveformComponent::timerCallback() {
-    // Check if we need to update the waveform
-    if (waveformNeedsRedraw.load()) {
-        // Use mutex to protect the cache update, but not the data acquisition
-        std::lock_guard<std::mutex> lock(waveformMutex);
-        updateWaveformCache();
-        waveformNeedsRedraw.store(false);
-        repaint();
+bool WaveformComponent::updateFrame() {
+    readQueuedPeaks();
+
+    if (!waveformCache.isValid() || history.size() != static_cast<size_t>(waveformCache.getWidth())) {
+        return false;
+    }
+
+    // Only the columns that arrived since the last frame are drawn, unless everything changed
+    if (fullRedrawNeeded || newColumns >= waveformCache.getWidth()) {
+        redrawWaveformCache();
+    } else if (newColumns > 0) {
+        scrollWaveformCache(newColumns);
+    } else {
+        return false;
     }
-} 
\ No newline at end of file
+
+    fullRedrawNeeded = false;
+    newColumns = 0;
+    return true;
+}
@@ -2,16 +2,15 @@
 
 #include <juce_gui_basics/juce_gui_basics.h>
 #include <vector>
-#include <atomic>
-#include <mutex>
-#include "../../Audio/Util/AudioBufferQueue.h"
+#include "../../Audio/Util/PeakQueue.h"
+#include "../FrameScheduler.h"
 
 /**
  * A dedicated component for visualizing audio waveforms.
- * Uses a lock-free mechanism to receive audio data from the audio thread
- * and display it on the GUI thread without blocking.
+ * Pops min/max peaks the audio thread queues, one per pixel column,
+ * and displays them on the GUI thread without blocking.
  */
-class WaveformComponent : public juce::Component, private juce::Timer
+class WaveformComponent : public juce::Component, private FrameScheduler::Client
 {
 public:
     WaveformComponent();
@@ -20,8 +19,8 @@ public:
     void paint(juce::Graphics& g) override;
     void resized() override;
     
-    // Set the sample rate for audio visualization
-    void setSampleRate(float newSampleRate);
+    // Set the queue the audio thread pushes its output peaks into
+    void setPeakQueue(PeakQueue* queue);
     
     // Set time range in seconds (for scaling the waveform)
     void setTimeRange(float seconds);
@@ -38,38 +37,38 @@ public:
     // Set transparency of the waveform (0.0 = invisible, 1.0 = fully opaque)
     void setWaveformAlpha(float alpha);
     
-    // Thread-safe method to push audio buffer from audio thread
-    void pushAudioBuffer(const float* audioData, int numSamples);
-    
 private:
-    // Initialize the waveform rendering system
-    void setupWaveformRendering();
+    // Asks the producer for one peak per pixel over the time range
+    void updatePeakResolution();
+    
+    // Moves queued peaks into the history and counts the new columns
+    void readQueuedPeaks();
+    
+    // Redraws the whole waveform cache image
+    void redrawWaveformCache();
     
-    // Update the waveform cache image
-    void updateWaveformCache();
+    // Scrolls the cached image left by numColumns and draws only the new columns on the right
+    void scrollWaveformCache(int numColumns);
     
-    // Timer callback to update visualization
-    void timerCallback() override;
+    // Draws the history's columns into the cache, which must already be cleared there
+    void drawColumns(int firstColumn, int numColumns);
+    
+    // Scrolls in the peaks queued since the last frame
+    bool updateFrame() override;
     
     // Waveform visualization
-    // strong ref for the gui thread
-    std::shared_ptr<AudioBufferQueue> audioBufferQueue;
-    // weak ref for the audio thread (to avoid trying to write to buffer when gui thread already shutdown)
-    std::weak_ptr<AudioBufferQueue> audioBufferQueueWeak;
-    std::vector<float> waveformData;
-    
-    struct PeakData {
-        float min = 0.0f;
-        float max = 0.0f;
-    };
-    
-    std::vector<PeakData> waveformPeaks;
+    PeakQueue* peakQueue = nullptr;
+    std::vector<PeakQueue::Peak> popScratch;
+    
+    // The most recent peak per pixel column, oldest at historyWrite
+    std::vector<PeakQueue::Peak> history;
+    size_t historyWrite = 0;
+    
     juce::Image waveformCache;
-    std::atomic<bool> waveformNeedsRedraw{false};
-    std::mutex waveformMutex;
+    bool fullRedrawNeeded = false; // Resize or settings change
+    int newColumns = 0;            // Peaks arrived since the cache was last drawn
     
     // Waveform settings
-    float sampleRate = 44100.0f;
     float timeRangeInSeconds = 1.0f;
     float waveformScaleFactor = 1.0f;
     float waveformAlpha = 0.5f;
@@ -77,4 +76,4 @@ private:
     juce::Colour backgroundColour = juce::Colour(0xff222222);
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WaveformComponent)
-}; 
\ No newline at end of file
+}; 
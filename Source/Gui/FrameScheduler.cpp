@@ -0,0 +1,97 @@
+#include "FrameScheduler.h"
+#include <algorithm>
+
+FrameScheduler::Client::Client(juce::Component &componentToUpdate, int maxRateHz)
+        : component(componentToUpdate), intervalMs(maxRateHz > 0 ? 1000.0 / maxRateHz : 0.0) {
+    component.addComponentListener(this);
+}
+
+FrameScheduler::Client::~Client() {
+    attach(nullptr);
+    component.removeComponentListener(this);
+}
+
+void FrameScheduler::Client::attach(FrameScheduler *newScheduler) {
+    if (scheduler == newScheduler) {
+        return;
+    }
+
+    if (scheduler != nullptr) {
+        scheduler->remove(*this);
+    }
+    if (newScheduler != nullptr) {
+        newScheduler->add(*this);
+    }
+}
+
+void FrameScheduler::Client::componentParentHierarchyChanged(juce::Component &) {
+    auto *host = dynamic_cast<Host *>(&component);
+    if (host == nullptr) {
+        host = component.findParentComponentOfClass<Host>();
+    }
+    attach(host != nullptr ? &host->getFrameScheduler() : nullptr);
+}
+
+FrameScheduler::FrameScheduler(juce::Component &editor)
+        : vBlank(&editor, [this] { onFrame(); }) {}
+
+FrameScheduler::~FrameScheduler() {
+    for (auto *client: clients) {
+        if (client != nullptr) {
+            client->scheduler = nullptr;
+        }
+    }
+}
+
+void FrameScheduler::add(Client &client) {
+    client.scheduler = this;
+    client.nextUpdateMs = 0.0;
+    clients.push_back(&client);
+}
+
+void FrameScheduler::remove(Client &client) {
+    // Clients may go away while the frame is being run, so the slot is only emptied here
+    if (auto it = std::find(clients.begin(), clients.end(), &client); it != clients.end()) {
+        *it = nullptr;
+        clientsRemoved = true;
+    }
+    dirtyComponents.erase(std::remove(dirtyComponents.begin(), dirtyComponents.end(), &client.component),
+                          dirtyComponents.end());
+    client.scheduler = nullptr;
+}
+
+void FrameScheduler::onFrame() {
+    const double now = juce::Time::getMillisecondCounterHiRes();
+
+    // Clients added during the frame start with the next one
+    const size_t numClients = clients.size();
+    for (size_t i = 0; i < numClients; ++i) {
+        auto *client = clients[i];
+        if (client == nullptr || !client->component.isShowing()) {
+            continue;
+        }
+
+        if (client->intervalMs > 0.0) {
+            if (now < client->nextUpdateMs - frameToleranceMs) {
+                continue;
+            }
+            // After a stall the schedule restarts from now instead of catching up
+            client->nextUpdateMs = juce::jmax(client->nextUpdateMs, now - frameToleranceMs) + client->intervalMs;
+        }
+
+        if (client->updateFrame() || client->dirty) {
+            client->dirty = false;
+            dirtyComponents.push_back(&client->component);
+        }
+    }
+
+    for (auto *component: dirtyComponents) {
+        component->repaint();
+    }
+    dirtyComponents.clear();
+
+    if (clientsRemoved) {
+        clients.erase(std::remove(clients.begin(), clients.end(), nullptr), clients.end());
+        clientsRemoved = false;
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#include <vector>
+
+/**
+ * Drives every animated part of the editor from one callback per display frame, in place of
+ * a timer per component. Clients are polled only while their component is showing and no more
+ * often than their rate. The repaints they ask for are issued together once every client has
+ * been polled, so they land in the same paint pass.
+ */
+class FrameScheduler {
+public:
+    // Implemented by the editor that owns the scheduler, clients find it through their parents
+    class Host {
+    public:
+        virtual ~Host() = default;
+
+        virtual FrameScheduler &getFrameScheduler() = 0;
+    };
+
+    /**
+     * Base for components animated by the scheduler. Subscribes itself whenever the component
+     * is placed inside a Host, so constructors need no access to the editor.
+     */
+    class Client : private juce::ComponentListener {
+    public:
+        // maxRateHz of 0 polls every frame
+        Client(juce::Component &component, int maxRateHz);
+
+        ~Client() override;
+
+        // Once per frame while the component is showing, returns true if it needs a repaint
+        virtual bool updateFrame() = 0;
+
+        // Has the component repainted in the next frame's batch
+        void markDirty() { dirty = true; }
+
+    private:
+        friend class FrameScheduler;
+
+        juce::Component &component;
+        double intervalMs;
+        double nextUpdateMs = 0.0;
+        bool dirty = false;
+        FrameScheduler *scheduler = nullptr;
+
+        void attach(FrameScheduler *newScheduler);
+
+        void componentParentHierarchyChanged(juce::Component &) override;
+    };
+
+    explicit FrameScheduler(juce::Component &editor);
+
+    ~FrameScheduler();
+
+    // For the host itself, children are added as they are placed inside it
+    void add(Client &client);
+
+    void remove(Client &client);
+
+private:
+    // Rates are met to within this, otherwise a 30 Hz client on a 60 Hz display could miss alternate frames
+    static constexpr double frameToleranceMs = 2.0;
+
+    std::vector<Client *> clients;
+    bool clientsRemoved = false;
+    std::vector<juce::Component *> dirtyComponents;
+    juce::VBlankAttachment vBlank;
+
+    void onFrame();
+};
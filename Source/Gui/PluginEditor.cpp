@@ -1,7 +1,7 @@
 #include "PluginEditor.h"
 
 PluginEditor::PluginEditor(PluginProcessor &p)
-        : AudioProcessorEditor(&p), audioProcessor(p) {
+        : AudioProcessorEditor(&p), FrameScheduler::Client(*this, 30), audioProcessor(p) {
     setLookAndFeel(&customLookAndFeel);
 
     header = std::make_unique<HeaderComponent>(audioProcessor);
@@ -29,11 +29,15 @@ PluginEditor::PluginEditor(PluginProcessor &p)
 
     setSize(800, 800);
 
-    startTimerHz(30);
+    // Events queued while no editor was open are stale, which may include the NoteOn of a note
+    // still sounding. Start from the engine's current state instead, anything it does after
+    // the discard is still queued
+    audioProcessor.getEngineEvents().discardAll();
+    seedFromEngineState();
+    frameScheduler.add(*this);
 }
 
 PluginEditor::~PluginEditor() {
-    stopTimer();
     setLookAndFeel(nullptr);
 }
 
@@ -101,20 +105,38 @@ void PluginEditor::setupKeyboard() {
     addAndMakeVisible(keyboardComponent.get());
 }
 
-void PluginEditor::updateKeyboardState(bool isNoteOn, int noteNumber, int velocity) {
-    if (keyboardState != nullptr) {
-        if (isNoteOn)
-            keyboardState->noteOn(1, noteNumber, static_cast<float>(velocity) / 127.0f);
-        else
-            keyboardState->noteOff(1, noteNumber, 0.0f);
+void PluginEditor::seedFromEngineState() {
+    const auto &noteGenerator = audioProcessor.getNoteGenerator();
 
-        keyboardNeedsUpdate = true;
+    if (const int note = noteGenerator.getCurrentActiveNote(); note >= 0 && noteGenerator.isNoteActive()) {
+        keyboardState->noteOn(1, note, static_cast<float>(noteGenerator.getCurrentActiveVelocity()) / 127.0f);
     }
+    sampleSection->setActiveSampleIndex(noteGenerator.getCurrentActiveSampleIdx());
 }
 
-void PluginEditor::setWaveformAudioBuffer(const float *audioData, int numSamples) {
-    if (envelopeSection != nullptr)
-        envelopeSection->pushAudioBuffer(audioData, numSamples);
+void PluginEditor::handleEngineEvents() {
+    auto &events = audioProcessor.getEngineEvents();
+
+    // The keyboard repaints the keys whose state changed itself. Dropped events may include
+    // note offs, so start it over rather than leave keys held
+    if (events.checkAndClearOverflow()) {
+        keyboardState->allNotesOff(1);
+    }
+
+    EngineEvent event;
+    while (events.pop(event)) {
+        switch (event.type) {
+            case EngineEvent::Type::NoteOn:
+                keyboardState->noteOn(1, event.noteNumber, static_cast<float>(event.velocity) / 127.0f);
+                break;
+            case EngineEvent::Type::NoteOff:
+                keyboardState->noteOff(1, event.noteNumber, 0.0f);
+                break;
+            case EngineEvent::Type::ActiveSampleChanged:
+                sampleSection->setActiveSampleIndex(event.sampleIndex);
+                break;
+        }
+    }
 }
 
 void PluginEditor::switchTab(HeaderComponent::Tab tab) {
@@ -129,22 +151,11 @@ void PluginEditor::switchTab(HeaderComponent::Tab tab) {
     resized();
 }
 
-void PluginEditor::timerCallback() {
-    if (grooveSection && grooveSection->isVisible()) {
-        grooveSection->repaintRandomizationControls();
-        grooveSection->updateRateLabelsForRhythmMode();
-    }
+bool PluginEditor::updateFrame() {
+    // Animated children are clients of the scheduler themselves, their repaints land in its batch
+    handleEngineEvents();
 
-    if (keyboardNeedsUpdate && keyboardComponent != nullptr) {
-        keyboardComponent->repaint();
-        keyboardNeedsUpdate = false;
-    }
-
-    if (isShowing() && keyboardComponent != nullptr && !audioProcessor.isNoteActive()
-        && keyboardState != nullptr) {
-        keyboardState->allNotesOff(1);
-        keyboardComponent->repaint();
-    }
+    return false;
 }
 
 bool PluginEditor::isInterestedInFileDrag(const juce::StringArray &files) {
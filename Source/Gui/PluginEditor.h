@@ -10,10 +10,12 @@
 #include "melatonin_inspector/melatonin_inspector.h"
 #include "Sections/EnvelopeSection.h"
 #include "Components/HeaderComponent.h"
+#include "FrameScheduler.h"
 
 class PluginEditor
         : public juce::AudioProcessorEditor,
-          private juce::Timer,
+          public FrameScheduler::Host,
+          private FrameScheduler::Client,
           public juce::FileDragAndDropTarget,
           public juce::DragAndDropContainer {
 public:
@@ -25,10 +27,6 @@ public:
 
     void resized() override;
 
-    void updateKeyboardState(bool isNoteOn, int noteNumber, int velocity);
-
-    void setWaveformAudioBuffer(const float *audioData, int numSamples);
-
     bool isInterestedInFileDrag(const juce::StringArray &files) override;
 
     void filesDropped(const juce::StringArray &files, int x, int y) override;
@@ -37,11 +35,16 @@ public:
 
     void fileDragExit(const juce::StringArray &files) override;
 
+    FrameScheduler &getFrameScheduler() override { return frameScheduler; }
+
 private:
     PluginProcessor &audioProcessor;
     LookAndFeel customLookAndFeel;
 //    melatonin::Inspector inspector{*this};
 
+    // Declared ahead of the sections, so it outlives the clients inside them
+    FrameScheduler frameScheduler{*this};
+
     std::unique_ptr<HeaderComponent> header;
 
     std::unique_ptr<GrooveSectionComponent> grooveSection;
@@ -53,11 +56,16 @@ private:
 
     std::unique_ptr<juce::MidiKeyboardState> keyboardState;
     std::unique_ptr<juce::MidiKeyboardComponent> keyboardComponent;
-    std::atomic<bool> keyboardNeedsUpdate = false;
 
     void setupKeyboard();
 
-    void timerCallback() override;
+    // Shows the note and sample playing when the editor opens
+    void seedFromEngineState();
+
+    // Applies the notes and state changes the engine queued since the last frame
+    void handleEngineEvents();
+
+    bool updateFrame() override;
 
     void switchTab(HeaderComponent::Tab tab);
 
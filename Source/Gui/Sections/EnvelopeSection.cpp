@@ -18,6 +18,7 @@ EnvelopeSection::EnvelopeSection(PluginEditor &editor, PluginProcessor &processo
     waveformComponent.setWaveformAlpha(0.3f);
     waveformComponent.setWaveformColour(juce::Colour(0xff52bfd9));
     waveformComponent.setWaveformScaleFactor(1.0f);
+    waveformComponent.setPeakQueue(&processor.getOutputPeaks());
     addAndMakeVisible(waveformComponent);
 
     createLFOComponents();
@@ -91,18 +92,10 @@ void EnvelopeSection::updateTimeRangeFromRate(Models::LFORate newRate) {
     setTimeRange(calculateTimeRangeInSeconds(newRate));
 }
 
-void EnvelopeSection::setSampleRate(float newSampleRate) {
-    waveformComponent.setSampleRate(newSampleRate);
-}
-
 void EnvelopeSection::setTimeRange(float seconds) {
     waveformComponent.setTimeRange(seconds);
 }
 
-void EnvelopeSection::pushAudioBuffer(const float *audioData, int numSamples) {
-    waveformComponent.pushAudioBuffer(audioData, numSamples);
-}
-
 float EnvelopeSection::calculateTimeRangeInSeconds(Models::LFORate newRate) const {
     double bpm = processor.getTimingManager().getBpm();
     const double beatsPerSecond = bpm / 60.0;
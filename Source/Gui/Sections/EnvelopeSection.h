@@ -23,12 +23,8 @@ public:
 
     void resized() override;
 
-    void setSampleRate(float newSampleRate);
-
     void setTimeRange(float seconds);
 
-    void pushAudioBuffer(const float *audioData, int numSamples);
-
     std::shared_ptr<EnvelopeComponent> getLFOComponent(int index) {
         return lfoComponents[index];
     }
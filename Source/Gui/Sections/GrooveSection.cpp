@@ -146,6 +146,8 @@ void GrooveSectionComponent::setupGateControls() {
     // Create gate knob
     initKnob(gateKnob, "Gate length", "gate");
     addAndMakeVisible(gateKnob.get());
+    gateRandomWatcher = std::make_unique<RandomizedValueWatcher>(
+            *gateKnob, [this] { return processor.getCurrentRandomizedGate(); });
 
     // Create gate label
     initLabel(gateLabel, "GATE", juce::Justification::centred);
@@ -171,6 +173,8 @@ void GrooveSectionComponent::setupVelocityControls() {
     // Create velocity knob
     initKnob(velocityKnob, "Velocity", "velocity");
     addAndMakeVisible(velocityKnob.get());
+    velocityRandomWatcher = std::make_unique<RandomizedValueWatcher>(
+            *velocityKnob, [this] { return processor.getCurrentRandomizedVelocity(); });
 
     // Create velocity label
     initLabel(velocityLabel, "VELO", juce::Justification::centred);
@@ -232,14 +236,6 @@ void GrooveSectionComponent::updateRateLabelsForRhythmMode() {
     }
 }
 
-void GrooveSectionComponent::repaintRandomizationControls() {
-    // Repaint knobs with randomization
-    if (gateKnob != nullptr)
-        gateKnob->repaint();
-    if (velocityKnob != nullptr)
-        velocityKnob->repaint();
-}
-
 void GrooveSectionComponent::setupDirectionControls() {
     // Create gate direction selector
     gateDirectionSelector = std::make_unique<DirectionSelector>(juce::Colour(0xff52bfd9));
@@ -8,6 +8,7 @@
 #include "BaseSection.h"
 #include "../../Shared/Models.h"
 #include "../Components/DirectionSelector.h"
+#include "../FrameScheduler.h"
 
 class GrooveSectionComponent : public BaseSectionComponent
 {
@@ -20,10 +21,27 @@ public:
     // Update rate labels based on rhythm mode
     void updateRateLabelsForRhythmMode();
 
-    // Repaint controls with randomization values
-    void repaintRandomizationControls();
-
 private:
+    // Repaints a knob in the scheduler's batch whenever the engine's randomized value for it changes
+    class RandomizedValueWatcher : private FrameScheduler::Client {
+    public:
+        RandomizedValueWatcher(juce::Slider &knob, std::function<float()> getValue)
+                : FrameScheduler::Client(knob, 30), getRandomizedValue(std::move(getValue)) {}
+
+    private:
+        std::function<float()> getRandomizedValue;
+        float lastValue = -1.0f;
+
+        bool updateFrame() override {
+            const float value = getRandomizedValue();
+            if (value == lastValue) {
+                return false;
+            }
+            lastValue = value;
+            return true;
+        }
+    };
+
     // UI Components
     std::array<std::unique_ptr<juce::Slider>, Models::NUM_RATE_OPTIONS> rateKnobs;
     std::array<std::unique_ptr<juce::Label>, Models::NUM_RATE_OPTIONS> rateLabels;
@@ -47,6 +65,10 @@ private:
     std::unique_ptr<DirectionSelector> gateDirectionSelector;
     std::unique_ptr<DirectionSelector> velocityDirectionSelector;
 
+    // Declared after the knobs they watch, so they are destroyed first
+    std::unique_ptr<RandomizedValueWatcher> gateRandomWatcher;
+    std::unique_ptr<RandomizedValueWatcher> velocityRandomWatcher;
+
     // Setup methods
     void setupRateControls();
     void setupRhythmModeControls();
@@ -2,13 +2,12 @@
 
 SampleSectionComponent::SampleSectionComponent(PluginEditor &editorRef,
                                                PluginProcessor &processorRef)
-        : BaseSectionComponent(editorRef, processorRef, "SAMPLE", juce::Colour(0xffbf52d9)) {
+        : BaseSectionComponent(editorRef, processorRef, "SAMPLE", juce::Colour(0xffbf52d9)),
+          FrameScheduler::Client(*this, 30) {
     initComponents(processorRef);
-    startTimerHz(30);
 }
 
 SampleSectionComponent::~SampleSectionComponent() {
-    stopTimer();
     clearAttachments();
 }
 
@@ -325,19 +324,29 @@ void SampleSectionComponent::paint(juce::Graphics &g) {
     }
 }
 
-void SampleSectionComponent::timerCallback() {
-    // Get the currently active sample index from the processor
-    int currentActiveSample = processor.getNoteGenerator().getCurrentActiveSampleIdx();
+void SampleSectionComponent::setActiveSampleIndex(int index) {
+    lastActiveSampleIndex = index;
 
-    // If the active sample has changed, update the display
-    if (currentActiveSample != lastActiveSampleIndex) {
-        lastActiveSampleIndex = currentActiveSample;
+    if (!showingDetailView) {
+        // Update the sample list's active index
+        sampleList->setActiveSampleIndex(index);
+    }
+}
 
-        if (!showingDetailView) {
-            // Update the sample list's active index
-            sampleList->setActiveSampleIndex(currentActiveSample);
-        }
+bool SampleSectionComponent::updateFrame() {
+    // Imports land asynchronously, refresh the rows when they arrive. The list animates their progress itself
+    auto &sampleManager = processor.getSampleManager();
+    const int numSamples = static_cast<int>(sampleManager.getNumSamples());
+    const int numPendingImports = sampleManager.getNumPendingImports();
+
+    if (numSamples != lastNumSamples || numPendingImports != lastNumPendingImports) {
+        lastNumSamples = numSamples;
+        lastNumPendingImports = numPendingImports;
+        sampleList->updateContent();
+        updateTabVisibility();
     }
+
+    return false;
 }
 
 bool SampleSectionComponent::isInterestedInFileDrag(const juce::StringArray &files) {
@@ -358,18 +367,19 @@ void SampleSectionComponent::filesDropped(const juce::StringArray &files, int, i
     // Reset the drag state
     draggedOver = false;
 
-    // Process the dropped files
-    bool needsUpdate = false;
+    // Collect the dropped files, they are decoded and analysed in the background
+    juce::Array<juce::File> filesToImport;
 
     for (const auto &file: files) {
         juce::File f(file);
         if (f.existsAsFile() && f.hasFileExtension("wav;aif;aiff;mp3")) {
-            processor.getSampleManager().addSample(f);
-            needsUpdate = true;
+            filesToImport.add(f);
         }
     }
 
-    if (needsUpdate) {
+    if (!filesToImport.isEmpty()) {
+        processor.getSampleManager().importSamples(filesToImport);
+
         // Refresh the list content
         sampleList->updateContent();
 
@@ -405,6 +415,9 @@ void SampleSectionComponent::showListView() {
     // Force a layout refresh
     resized();
     sampleList->updateContent();
+
+    // The highlight is not followed while the detail view is open
+    sampleList->setActiveSampleIndex(lastActiveSampleIndex);
 }
 
 void SampleSectionComponent::showDetailViewForSample(int sampleIndex) {
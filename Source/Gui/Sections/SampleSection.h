@@ -8,6 +8,7 @@
 #include "../../Audio/Sampler/OnsetDetector.h"
 #include "../../Shared/Models.h"
 #include "../Components/Toggle.h"
+#include "../FrameScheduler.h"
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_audio_utils/juce_audio_utils.h>
 
@@ -34,7 +35,7 @@ public:
 
 class SampleSectionComponent : public BaseSectionComponent,
                                public juce::FileDragAndDropTarget,
-                               private juce::Timer {
+                               private FrameScheduler::Client {
 public:
     SampleSectionComponent(PluginEditor &editor, PluginProcessor &processor);
 
@@ -54,8 +55,11 @@ public:
 
     void fileDragExit(const juce::StringArray &files) override;
 
-    // Timer callback for updating the active sample highlight
-    void timerCallback() override;
+    // Highlights the sample the engine is playing, -1 for none
+    void setActiveSampleIndex(int index);
+
+    // Follows pending imports
+    bool updateFrame() override;
 
 private:
     // UI Components
@@ -84,6 +88,8 @@ private:
 
     // Track the currently active sample for highlighting
     int lastActiveSampleIndex = -1;
+    int lastNumSamples = 0;
+    int lastNumPendingImports = 0;
 
     bool draggedOver = false;
 
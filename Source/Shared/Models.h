@@ -54,6 +54,13 @@ namespace Models {
         RANDOM
     };
 
+    enum InterpolationMode {
+        INTERPOLATION_LINEAR = 0,
+        INTERPOLATION_HERMITE,
+        INTERPOLATION_SINC,
+        NUM_INTERPOLATION_MODES
+    };
+
     enum EffectType {
         REVERB = 0,
         STUTTER,
@@ -129,6 +136,10 @@ namespace Models {
         float velocityRandomize = 0.0f;    // 0-100% (how much to randomize the velocity)
         DirectionType velocityDirection = RIGHT; // Direction of randomization
 
+        // Live input, hits on the input bus trigger notes
+        bool inputOnsets = false;
+        float inputOnsetSensitivity = 0.5f;
+
         float getRateValueByIdx(int idx) {
             switch (idx) {
                 case RATE_1_1:
@@ -21,6 +21,9 @@ namespace Params {
     static const juce::String ID_VELOCITY_DIRECTION = "velocity_direction";
     // Rhythm mode parameters
     static const juce::String ID_RHYTHM_MODE = "rhythm_mode";
+    // Live input parameters
+    static const juce::String ID_INPUT_ONSETS = "input_onsets";
+    static const juce::String ID_INPUT_ONSET_SENSITIVITY = "input_onset_sensitivity";
     // Rhythm subdivision parameters
     static const juce::String ID_RHYTHM_1_1 = "1/1";
     static const juce::String ID_RHYTHM_1_2 = "1/2";
@@ -42,6 +45,16 @@ namespace Params {
     // Sample parameters
     static const juce::String ID_SAMPLE_DIRECTION = "sample_direction";
     static const juce::String ID_SAMPLE_PITCH_FOLLOW = "sample_pitch_follow";
+    static const juce::String ID_SAMPLE_INTERPOLATION = "sample_interpolation";
+    static const juce::String ID_SAMPLE_INTERPOLATION_OFFLINE = "sample_interpolation_offline";
+    static const juce::String ID_SAMPLE_VOICES = "sample_voices";
+    static const juce::String ID_SAMPLE_STREAMING = "sample_streaming";
+    static const juce::String ID_SAMPLE_MEMORY_MAP = "sample_memory_map";
+    static const juce::String ID_SAMPLE_WARM_PAGES = "sample_warm_pages";
+    static const juce::String ID_SAMPLE_RESAMPLE = "sample_resample";
+    static const juce::String ID_SAMPLE_COMPACT = "sample_compact";
+    static const juce::String ID_SAMPLE_SLICE_ORDER = "sample_slice_order";
+    static const juce::String ID_SAMPLE_BEAT_SYNC = "sample_beat_sync";
 
     // Stutter parameters
     static const juce::String ID_STUTTER_PROBABILITY = "stutter_probability";
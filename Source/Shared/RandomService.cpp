@@ -0,0 +1,91 @@
+#include "RandomService.h"
+
+namespace {
+    std::uint64_t rotateLeft(std::uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    // Spreads a 64-bit seed over the generator state, as recommended for xoshiro
+    std::uint64_t splitMix64(std::uint64_t &x) {
+        std::uint64_t z = (x += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+}
+
+void RandomStream::setSeed(std::uint64_t seed) {
+    for (auto &word: state) {
+        word = splitMix64(seed);
+    }
+}
+
+std::uint64_t RandomStream::nextUInt64() {
+    const std::uint64_t result = rotateLeft(state[1] * 5, 7) * 9;
+    const std::uint64_t t = state[1] << 17;
+
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = rotateLeft(state[3], 45);
+
+    return result;
+}
+
+void RandomStream::jump() {
+    static constexpr std::uint64_t jumpPolynomial[] = {0x180ec6d33cfd0abaull, 0xd5a61266f0c9392cull,
+                                                       0xa9582618e03fc9aaull, 0x39abdc4529b1661cull};
+
+    std::array<std::uint64_t, 4> jumped{};
+    for (const std::uint64_t word: jumpPolynomial) {
+        for (int bit = 0; bit < 64; ++bit) {
+            if ((word & (std::uint64_t{1} << bit)) != 0) {
+                for (size_t i = 0; i < jumped.size(); ++i) {
+                    jumped[i] ^= state[i];
+                }
+            }
+            nextUInt64();
+        }
+    }
+
+    state = jumped;
+}
+
+int RandomStream::nextInt(int maxValue) {
+    if (maxValue <= 0) {
+        return 0;
+    }
+
+    // Multiply-shift maps the top 32 bits onto the range without a division
+    return static_cast<int>(((nextUInt64() >> 32) * static_cast<std::uint64_t>(maxValue)) >> 32);
+}
+
+RandomService::RandomService() {
+    setSeed(static_cast<std::uint64_t>(juce::Random::getSystemRandom().nextInt64()));
+    restart();
+}
+
+void RandomService::setSeed(std::uint64_t newSeed) {
+    seed.store(newSeed, std::memory_order_relaxed);
+    seedChanged.store(true, std::memory_order_release);
+}
+
+void RandomService::restart() {
+    seedChanged.store(false, std::memory_order_relaxed);
+
+    RandomStream base;
+    base.setSeed(seed.load(std::memory_order_acquire));
+
+    for (auto &stream: streams) {
+        stream = base;
+        base.jump();
+    }
+}
+
+void RandomService::applyPendingSeed() {
+    if (seedChanged.load(std::memory_order_acquire)) {
+        restart();
+    }
+}
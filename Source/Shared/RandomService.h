@@ -0,0 +1,75 @@
+#pragma once
+
+#include "juce_core/juce_core.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * xoshiro256** generator. A few shifts and rotates per number, no locks or system calls,
+ * so it is safe to draw from on the audio thread.
+ */
+class RandomStream {
+public:
+    void setSeed(std::uint64_t seed);
+
+    // Advances by 2^128 numbers, streams split off this way never overlap
+    void jump();
+
+    std::uint64_t nextUInt64();
+
+    // Uniform in [0, 1)
+    float nextFloat() { return static_cast<float>(nextUInt64() >> 40) * 0x1.0p-24f; }
+
+    double nextDouble() { return static_cast<double>(nextUInt64() >> 11) * 0x1.0p-53; }
+
+    // Uniform in [0, maxValue), 0 if maxValue is not positive
+    int nextInt(int maxValue);
+
+    bool nextBool() { return (nextUInt64() >> 63) != 0; }
+
+private:
+    std::array<std::uint64_t, 4> state{};
+};
+
+/**
+ * Every random decision an instance makes comes from here, one independent stream per
+ * subsystem so that changing how often one of them draws leaves the others' sequences
+ * alone. The seed is saved with the plugin state: playing the same material from the same
+ * seed after prepareToPlay gives the same render, bit for bit.
+ */
+class RandomService {
+public:
+    enum class Stream {
+        Notes,
+        Melody,
+        Samples,
+        Effects,
+        Slices, // Random slice order, so it leaves sample choice alone
+        NumStreams
+    };
+
+    // Starts from a fresh seed, different for every instance
+    RandomService();
+
+    // Thread safe. The streams restart from the new seed at the start of the next block
+    void setSeed(std::uint64_t newSeed);
+
+    [[nodiscard]] std::uint64_t getSeed() const { return seed.load(std::memory_order_relaxed); }
+
+    // Audio thread: restarts every stream from the seed, e.g. when playback is prepared
+    void restart();
+
+    // Audio thread, once per block before any stream is used
+    void applyPendingSeed();
+
+    // Streams must only be drawn from on the audio thread
+    RandomStream &getStream(Stream stream) { return streams[static_cast<size_t>(stream)]; }
+
+private:
+    std::atomic<std::uint64_t> seed{0};
+    std::atomic<bool> seedChanged{false};
+    std::array<RandomStream, static_cast<size_t>(Stream::NumStreams)> streams;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RandomService)
+};
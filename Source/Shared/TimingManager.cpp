@@ -19,6 +19,7 @@ void TimingManager::prepareToPlay(double liveSampleRate) {
     ppqPosition = 0.0;
     lastPpqPosition = 0.0;
     lastContinuousPpqPosition = 0.0;
+    lastBarStartPpq = 0.0;
 
     // Reset trigger times
     for (int i = 0; i < Models::NUM_RATE_OPTIONS; i++) {
@@ -42,6 +43,15 @@ void TimingManager::updateTimingInfo(juce::AudioPlayHead *playHead) {
             if (posInfo->getBpm().hasValue())
                 bpm = *posInfo->getBpm();
 
+            if (const auto timeSig = posInfo->getTimeSignature();
+                timeSig.hasValue() && timeSig->numerator > 0 && timeSig->denominator > 0) {
+                timeSigNumerator = timeSig->numerator;
+                timeSigDenominator = timeSig->denominator;
+            }
+
+            if (posInfo->getPpqPositionOfLastBarStart().hasValue())
+                lastBarStartPpq = *posInfo->getPpqPositionOfLastBarStart();
+
             if (posInfo->getPpqPosition().hasValue()) {
                 ppqPosition = *posInfo->getPpqPosition();
 
@@ -26,6 +26,17 @@ public:
 
     double getLastPpqPosition() const { return lastPpqPosition; }
 
+    // Host time signature, 4/4 until the host reports one
+    int getTimeSigNumerator() const { return timeSigNumerator; }
+
+    int getTimeSigDenominator() const { return timeSigDenominator; }
+
+    // Length of a host bar in quarter notes, the unit of the ppq positions
+    double getQuartersPerBar() const { return timeSigNumerator * 4.0 / timeSigDenominator; }
+
+    // Ppq position where the current bar started, 0 if the host does not say
+    double getLastBarStartPpq() const { return lastBarStartPpq; }
+
     double getSampleRate() const { return sampleRate; }
 
     juce::int64 getSamplePosition() const { return samplePosition; }
@@ -63,6 +74,9 @@ private:
     double bpm = 120.0;
     double ppqPosition = 0.0;
     double lastPpqPosition = 0.0;
+    int timeSigNumerator = 4;
+    int timeSigDenominator = 4;
+    double lastBarStartPpq = 0.0;
     double lastTriggerTimes[Models::NUM_RATE_OPTIONS] = {0.0};
     bool loopJustDetected = false;
     double lastContinuousPpqPosition = 0.0;  // For detecting transport loops
@@ -1,5 +1,13 @@
 #include <catch2/catch_test_macros.hpp>
 #include <juce_core/juce_core.h>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "Audio/Sampler/OnsetDetector.h"
+#include "Audio/Sampler/SampleAnalysis.h"
+#include "Audio/Sampler/SampleSelector.h"
+#include "Audio/Util/EngineEventQueue.h"
+#include "Shared/RandomService.h"
 
 template <typename T>
 bool checkMin(T first, T second)
@@ -25,4 +33,248 @@ TEST_CASE("Test that juce::jmax works")
     REQUIRE(checkMax(5, 7));
     REQUIRE(checkMax(12, 3));
     REQUIRE(checkMax(5.31, 5.42));
-}
\ No newline at end of file
+}
+
+TEST_CASE("AliasTable picks entries in proportion to their weights")
+{
+    AliasTable table;
+    table.build({1.0f, 0.0f, 3.0f, 4.0f});
+    REQUIRE(table.size() == 4);
+
+    // Evenly spaced draws stand in for a uniform source
+    const int numDraws = 100000;
+    std::vector<int> counts(4, 0);
+    for (int i = 0; i < numDraws; ++i)
+        ++counts[static_cast<size_t>(table.pick((i + 0.5) / numDraws))];
+
+    REQUIRE(counts[1] == 0);
+    REQUIRE(std::abs(counts[0] / static_cast<double>(numDraws) - 0.125) < 0.005);
+    REQUIRE(std::abs(counts[2] / static_cast<double>(numDraws) - 0.375) < 0.005);
+    REQUIRE(std::abs(counts[3] / static_cast<double>(numDraws) - 0.5) < 0.005);
+}
+
+TEST_CASE("AliasTable with no positive weight picks every entry evenly")
+{
+    AliasTable table;
+    table.build({0.0f, 0.0f, 0.0f});
+    REQUIRE(!table.isEmpty());
+
+    const int numDraws = 30000;
+    std::vector<int> counts(3, 0);
+    for (int i = 0; i < numDraws; ++i)
+        ++counts[static_cast<size_t>(table.pick((i + 0.5) / numDraws))];
+
+    for (auto count : counts)
+        REQUIRE(std::abs(count - numDraws / 3) <= 3);
+
+    table.build({});
+    REQUIRE(table.isEmpty());
+}
+
+TEST_CASE("RandomStream repeats its sequence for the same seed")
+{
+    RandomStream first, second;
+    first.setSeed(1234);
+    second.setSeed(1234);
+
+    std::vector<std::uint64_t> sequence;
+    for (int i = 0; i < 100; ++i)
+    {
+        sequence.push_back(first.nextUInt64());
+        REQUIRE(sequence.back() == second.nextUInt64());
+    }
+
+    RandomStream other;
+    other.setSeed(1235);
+    REQUIRE(other.nextUInt64() != sequence.front());
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        const double value = first.nextDouble();
+        REQUIRE(value >= 0.0);
+        REQUIRE(value < 1.0);
+        REQUIRE(first.nextInt(7) < 7);
+    }
+}
+
+TEST_CASE("RandomStream jump gives a different but repeatable sequence")
+{
+    RandomStream base, jumped, jumpedAgain;
+    base.setSeed(42);
+    jumped.setSeed(42);
+    jumpedAgain.setSeed(42);
+    jumped.jump();
+    jumpedAgain.jump();
+
+    for (int i = 0; i < 100; ++i)
+    {
+        const auto value = jumped.nextUInt64();
+        REQUIRE(value == jumpedAgain.nextUInt64());
+        REQUIRE(value != base.nextUInt64());
+    }
+}
+
+TEST_CASE("RandomService streams restart from the seed and differ from each other")
+{
+    RandomService first, second;
+    first.setSeed(99);
+    second.setSeed(99);
+    first.applyPendingSeed();
+    second.applyPendingSeed();
+
+    using Stream = RandomService::Stream;
+    const auto notes = first.getStream(Stream::Notes).nextUInt64();
+    REQUIRE(notes == second.getStream(Stream::Notes).nextUInt64());
+    REQUIRE(notes != first.getStream(Stream::Samples).nextUInt64());
+
+    // Drawing from one stream leaves the others' sequences alone
+    first.restart();
+    second.restart();
+    for (int i = 0; i < 10; ++i)
+        first.getStream(Stream::Effects).nextUInt64();
+    REQUIRE(first.getStream(Stream::Melody).nextUInt64() == second.getStream(Stream::Melody).nextUInt64());
+}
+
+namespace
+{
+    // The onset picking before the moving average became a running sum
+    std::vector<float> findOnsetsReference(std::vector<float> detectionFunction, int numSamples)
+    {
+        float maxValue = 0.0f;
+        for (auto value : detectionFunction)
+            maxValue = std::max(maxValue, std::abs(value));
+        if (maxValue > 0.0f)
+            for (auto& value : detectionFunction)
+                value /= maxValue;
+
+        const int windowSize = 10;
+        const int size = static_cast<int>(detectionFunction.size());
+        std::vector<float> movingAverage(detectionFunction.size());
+        for (int i = 0; i < size; ++i)
+        {
+            float sum = 0.0f;
+            int count = 0;
+            for (int j = std::max(0, i - windowSize / 2); j < std::min(size, i + windowSize / 2 + 1); ++j)
+            {
+                sum += detectionFunction[j];
+                ++count;
+            }
+            movingAverage[i] = sum / count;
+        }
+
+        std::vector<float> onsets;
+        for (int i = 1; i < size - 1; ++i)
+        {
+            const float adaptiveThreshold = movingAverage[i] * OnsetDetector::defaultThreshold
+                                            + OnsetDetector::defaultSensitivity * 0.1f;
+            if (detectionFunction[i] > adaptiveThreshold
+                && detectionFunction[i] > detectionFunction[i - 1]
+                && detectionFunction[i] > detectionFunction[i + 1])
+            {
+                onsets.push_back(static_cast<float>(i * OnsetDetector::hopSize) / numSamples);
+                i += 3;
+            }
+        }
+
+        return onsets;
+    }
+}
+
+TEST_CASE("OnsetDetector running-sum threshold finds the same onsets as the windowed average")
+{
+    juce::Random random(2025);
+    OnsetDetector detector;
+
+    for (int trial = 0; trial < 20; ++trial)
+    {
+        // Noise with sparse spikes, some close enough together to share an averaging window
+        std::vector<float> detectionFunction(static_cast<size_t>(200 + trial * 37));
+        for (auto& value : detectionFunction)
+            value = random.nextFloat() * 0.3f;
+        for (size_t i = 0; i < detectionFunction.size(); i += static_cast<size_t>(3 + random.nextInt(20)))
+            detectionFunction[i] += 0.5f + random.nextFloat() * 2.0f;
+
+        const int numSamples = static_cast<int>(detectionFunction.size()) * OnsetDetector::hopSize
+                               + OnsetDetector::frameSize;
+        const auto expected = findOnsetsReference(detectionFunction, numSamples);
+        REQUIRE(!expected.empty());
+        REQUIRE(detector.findOnsets(detectionFunction, numSamples) == expected);
+    }
+}
+
+TEST_CASE("PeakPyramid picks the coarsest level that fits the zoom")
+{
+    // Ten full base peaks and a partial one: 11, 6, 3, 2 and 1 peaks per level
+    const int numFrames = PeakPyramid::baseFramesPerPeak * 10 + 100;
+    std::vector<float> samples(static_cast<size_t>(numFrames));
+    for (int i = 0; i < numFrames; ++i)
+        samples[static_cast<size_t>(i)] = std::sin(static_cast<float>(i) * 0.01f) * (i == 1000 ? 2.0f : 1.0f);
+
+    PeakPyramid pyramid;
+    pyramid.reset(1);
+    const float* channels[] = {samples.data()};
+    pyramid.addFrames(channels, 1000);
+    channels[0] += 1000;
+    pyramid.addFrames(channels, numFrames - 1000);
+    pyramid.finish();
+
+    REQUIRE(pyramid.getNumFrames() == numFrames);
+    REQUIRE(pyramid.getNumLevels() == 5);
+    REQUIRE(pyramid.getPeaks(0, 0).size() == 11);
+    REQUIRE(pyramid.getPeaks(1, 0).size() == 6);
+    REQUIRE(pyramid.getPeaks(4, 0).size() == 1);
+
+    REQUIRE(pyramid.getLevelForResolution(1.0) == 0);
+    REQUIRE(pyramid.getLevelForResolution(PeakPyramid::baseFramesPerPeak) == 0);
+    REQUIRE(pyramid.getLevelForResolution(PeakPyramid::baseFramesPerPeak * 2) == 1);
+    REQUIRE(pyramid.getLevelForResolution(PeakPyramid::baseFramesPerPeak * 7.5) == 2);
+    REQUIRE(pyramid.getLevelForResolution(1.0e9) == 4);
+
+    // The whole-sample peak holds the extremes of every frame
+    const auto range = juce::FloatVectorOperations::findMinAndMax(samples.data(), numFrames);
+    REQUIRE(pyramid.getPeaks(4, 0)[0].min == range.getStart());
+    REQUIRE(pyramid.getPeaks(4, 0)[0].max == range.getEnd());
+}
+
+TEST_CASE("EngineEventQueue drops events when full and reports it once")
+{
+    EngineEventQueue queue;
+    EngineEvent event;
+    REQUIRE(!queue.pop(event));
+
+    for (int i = 0; i < EngineEventQueue::capacity; ++i)
+        queue.push({EngineEvent::Type::NoteOn, i, 100});
+    REQUIRE(!queue.checkAndClearOverflow());
+
+    queue.push({EngineEvent::Type::NoteOff, 999});
+    REQUIRE(queue.checkAndClearOverflow());
+    REQUIRE(!queue.checkAndClearOverflow());
+
+    // Oldest first, and the dropped event never shows up
+    for (int i = 0; i < EngineEventQueue::capacity; ++i)
+    {
+        REQUIRE(queue.pop(event));
+        REQUIRE(event.type == EngineEvent::Type::NoteOn);
+        REQUIRE(event.noteNumber == i);
+    }
+    REQUIRE(!queue.pop(event));
+}
+
+TEST_CASE("EngineEventQueue discardAll empties the queue and clears the overflow")
+{
+    EngineEventQueue queue;
+    for (int i = 0; i <= EngineEventQueue::capacity; ++i)
+        queue.push({EngineEvent::Type::ActiveSampleChanged, -1, 0, i});
+
+    queue.discardAll();
+
+    EngineEvent event;
+    REQUIRE(!queue.pop(event));
+    REQUIRE(!queue.checkAndClearOverflow());
+
+    // Slots freed by the discard take new events
+    queue.push({EngineEvent::Type::NoteOn, 60, 90});
+    REQUIRE(queue.pop(event));
+    REQUIRE(event.noteNumber == 60);
+    REQUIRE(event.velocity == 90);
+}